@@ -1,6 +1,24 @@
 #include "ChessGod.h"
 
 #include "Chess/ChessEngine.h"
+#include "Chess/GameHistory.h"
+#include "Chess/MoveCache.h"
+#include "Chess/Notation.h"
+#include "Chess/PieceTypeConversion.h"
+#include "Chess/Replay.h"
+#include "Core/HexaGameInstance.h"
+#include "Core/HexaSaveGame.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+
+
+namespace
+{
+    int32 ToCellKey(FIntPoint Cell)
+    {
+        return Cell.X < 0 || Cell.Y < 0 || Cell.Y > 0xff ? -1 : Board::to_position_key(Cell.X, Cell.Y);
+    }
+}
 
 
 AChessGod::AChessGod(const FObjectInitializer& ObjectInitializer)
@@ -20,11 +38,16 @@ void AChessGod::EndPlay(const EEndPlayReason::Type EndPlayReason)
     Super::EndPlay(EndPlayReason);
 
     EndGame();
+    delete LoadedReplayPlayer;
+    LoadedReplayPlayer = nullptr;
+    delete LoadedReplay;
+    LoadedReplay = nullptr;
 }
 
 void AChessGod::StartGame()
 {
     CreateLogicalBoard();
+    MinimaxAIComponent->ResetContext();
 }
 
 void AChessGod::EndGame()
@@ -34,89 +57,618 @@ void AChessGod::EndGame()
         delete ActiveBoard;
         ActiveBoard = nullptr;
     }
+    if (ActiveMoveCache != nullptr)
+    {
+        delete ActiveMoveCache;
+        ActiveMoveCache = nullptr;
+    }
+    if (ActiveGameHistory != nullptr)
+    {
+        delete ActiveGameHistory;
+        ActiveGameHistory = nullptr;
+    }
+    if (ActiveReplay != nullptr)
+    {
+        delete ActiveReplay;
+        ActiveReplay = nullptr;
+    }
 }
 
 void AChessGod::CreateLogicalBoard()
 {
+    EndGame();
+
     ActiveBoard = new Board();
+    ActiveMoveCache = new MoveCache();
+    ActiveGameHistory = new GameHistory();
+    ActiveReplay = new Replay();
+    ResetGameHistory(true, 0, 1);
+}
+
+void AChessGod::InvalidateMoveCache()
+{
+    if (ActiveMoveCache != nullptr)
+    {
+        ActiveMoveCache->invalidate();
+    }
+}
+
+void AChessGod::ResetGameHistory(bool IsWhiteToMove, int32 HalfmoveClock, int32 InFullmoveNumber)
+{
+    ActiveGameHistory->reset(ActiveBoard->get_hash(IsWhiteToMove), HalfmoveClock);
+    bIsWhiteToMove = IsWhiteToMove;
+    FullmoveNumber = InFullmoveNumber;
+    LastMoveFromKey = -1;
+    LastMoveToKey = -1;
+    bIsReplayPending = true;
+    ReplayPendingSince = FPlatformTime::Seconds();
+}
+
+void AChessGod::StartPendingReplay() const
+{
+    if (!bIsReplayPending || ActiveReplay == nullptr)
+    {
+        return;
+    }
+    PositionState State;
+    State.is_white_to_move = bIsWhiteToMove;
+    State.halfmove_clock = ActiveGameHistory->get_halfmove_clock();
+    State.fullmove_number = FullmoveNumber;
+    const chrono::duration<double> SinceReset(FPlatformTime::Seconds() - ReplayPendingSince);
+    ActiveReplay->start(format_position(*ActiveBoard, State), chrono::steady_clock::now() - chrono::duration_cast<chrono::steady_clock::duration>(SinceReset));
+    bIsReplayPending = false;
 }
 
 void AChessGod::RegisterPiece(FPieceInfo PieceInfo)
 {
-    const auto PieceType = [&]()
+    if (ActiveBoard == nullptr)
     {
-        switch (PieceInfo.Type)
+        CreateLogicalBoard();
+    }
+
+    const int32 CellKey = ToCellKey(FIntPoint{PieceInfo.X, PieceInfo.Y});
+    if (Board::to_cell_index(CellKey) == -1)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("RegisterPiece: (%d, %d) is off the board"), PieceInfo.X, PieceInfo.Y);
+        return;
+    }
+    Position PiecePosition = ActiveBoard->to_position(CellKey);
+    ActiveBoard->set_piece(PiecePosition, ToEnginePieceType(PieceInfo.Type), ToEnginePieceColor(PieceInfo.TeamID));
+    InvalidateMoveCache();
+    ResetGameHistory(true, 0, 1);
+}
+
+TArray<FBoardSetupConflict> AChessGod::SetupBoard(const TArray<FPieceInfo>& Pieces)
+{
+    if (ActiveBoard == nullptr)
+    {
+        CreateLogicalBoard();
+    }
+
+    vector<PiecePlacement> Placements;
+    Placements.reserve(Pieces.Num());
+    for (const FPieceInfo& Piece : Pieces)
+    {
+        // -1 for coordinates that would wrap onto another cell, setup_pieces reports it as an invalid cell
+        Placements.push_back(PiecePlacement{ToCellKey(FIntPoint{Piece.X, Piece.Y}), ToEnginePieceType(Piece.Type), ToEnginePieceColor(Piece.TeamID)});
+    }
+
+    vector<SetupConflict> EngineConflicts;
+    if (ActiveBoard->setup_pieces(Placements, EngineConflicts))
+    {
+        ResetGameHistory(true, 0, 1);
+    }
+    InvalidateMoveCache();
+
+    TArray<FBoardSetupConflict> Conflicts;
+    for (const SetupConflict& EngineConflict : EngineConflicts)
+    {
+        FBoardSetupConflict& Conflict = Conflicts.AddDefaulted_GetRef();
+        if (Pieces.IsValidIndex(EngineConflict.placement_index))
         {
-        case EPieceType::Pawn:
-            return Cell::PieceType::pawn;
-        case EPieceType::Knight:
-            return Cell::PieceType::knight;
-        case EPieceType::Bishop:
-            return Cell::PieceType::bishop;
-        case EPieceType::Rook:
-            return Cell::PieceType::rook;
-        case EPieceType::Queen:
-            return Cell::PieceType::queen;
-        case EPieceType::King:
-            return Cell::PieceType::king;
-        default:
-            return Cell::PieceType::pawn;
+            Conflict.Piece = Pieces[EngineConflict.placement_index];
         }
-    }();
+        switch (EngineConflict.reason)
+        {
+        case SetupConflict::invalid_cell:
+            Conflict.Type = EBoardSetupConflictType::InvalidCell;
+            Conflict.Message = FString::Printf(TEXT("(%d, %d) is not a board cell"), Conflict.Piece.X, Conflict.Piece.Y);
+            break;
+        case SetupConflict::occupied_cell:
+            Conflict.Type = EBoardSetupConflictType::OccupiedCell;
+            Conflict.Message = FString::Printf(TEXT("(%d, %d) already has a piece"), Conflict.Piece.X, Conflict.Piece.Y);
+            break;
+        case SetupConflict::king_count:
+            Conflict.Type = EBoardSetupConflictType::KingCount;
+            Conflict.Message = TEXT("each side needs exactly one king");
+            break;
+        }
+    }
+    return Conflicts;
+}
+
+TArray<FBoardSetupConflict> AChessGod::SetupFromNotation(const FString& Notation, bool& IsWhiteToMove)
+{
+    if (ActiveBoard == nullptr)
+    {
+        CreateLogicalBoard();
+    }
 
-    // crashes here:
-    Position PiecePosition = Position{PieceInfo.X, PieceInfo.Y};
-    ActiveBoard->set_piece(PiecePosition, PieceType, PieceInfo.TeamID == 0 ? Cell::PieceColor::white : Cell::PieceColor::black);
+    TArray<FBoardSetupConflict> Conflicts;
+    PositionState State;
+    string Error;
+    if (parse_position(*ActiveBoard, TCHAR_TO_UTF8(*Notation), State, &Error))
+    {
+        ResetGameHistory(State.is_white_to_move, State.halfmove_clock, State.fullmove_number);
+    }
+    else
+    {
+        FBoardSetupConflict& Conflict = Conflicts.AddDefaulted_GetRef();
+        Conflict.Type = EBoardSetupConflictType::InvalidNotation;
+        Conflict.Message = UTF8_TO_TCHAR(Error.c_str());
+    }
+    IsWhiteToMove = State.is_white_to_move;
+    InvalidateMoveCache();
+    return Conflicts;
+}
+
+FString AChessGod::GetNotation() const
+{
+    if (ActiveBoard == nullptr || ActiveGameHistory == nullptr)
+    {
+        return FString();
+    }
+
+    PositionState State;
+    State.is_white_to_move = bIsWhiteToMove;
+    State.halfmove_clock = ActiveGameHistory->get_halfmove_clock();
+    State.fullmove_number = FullmoveNumber;
+    return UTF8_TO_TCHAR(format_position(*ActiveBoard, State).c_str());
 }
 
 TArray<FIntPoint> AChessGod::GetMovesForCell(FIntPoint InPosition)
 {
     TArray<FIntPoint> Result;
 
-    Position PiecePosition = Position{InPosition.X, InPosition.Y};
-    list<Position> Moves = ActiveBoard->get_valid_moves(PiecePosition);
-
-    for (const auto& Move : Moves)
+    const int32 CellKey = ToCellKey(InPosition);
+    if (ActiveBoard == nullptr || Board::to_cell_index(CellKey) == -1)
+    {
+        return Result;
+    }
+    for (const int32 MoveKey : ActiveMoveCache->get_moves(*ActiveBoard, CellKey))
     {
-        Result.Add(FIntPoint{Move.x, Move.y});
+        Position MovePosition = ActiveBoard->to_position(MoveKey);
+        Result.Add(FIntPoint{MovePosition.x, MovePosition.y});
     }
 
     return Result;
 }
 
-void AChessGod::MovePiece(FIntPoint From, FIntPoint To)
+void AChessGod::MovePiece(FIntPoint From, FIntPoint To, EPieceType Promotion)
 {
-    Position FromPosition = Position{From.X, From.Y};
-    Position ToPosition = Position{To.X, To.Y};
+    const int32 FromKey = ToCellKey(From);
+    const int32 ToKey = ToCellKey(To);
+    if (ActiveBoard == nullptr || Board::to_cell_index(FromKey) == -1 || Board::to_cell_index(ToKey) == -1)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("MovePiece: (%d, %d) to (%d, %d) is off the board"), From.X, From.Y, To.X, To.Y);
+        return;
+    }
 
-    ActiveBoard->move_piece(FromPosition, ToPosition);
+    const Cell::PieceColor MoverColor = ActiveBoard->board_map[FromKey]->get_piece_color();
+    if (MoverColor != (bIsWhiteToMove ? Cell::PieceColor::white : Cell::PieceColor::black))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("MovePiece: (%d, %d) is not a piece of the side to move"), From.X, From.Y);
+        return;
+    }
+    const bool bIsPromotion = Board::is_promotion_move(ActiveBoard->board_map, FromKey, ToKey);
+    if (bIsPromotion && !IsPromotionPieceType(Promotion))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("MovePiece: (%d, %d) to (%d, %d) must promote to a queen, rook, bishop or knight"), From.X, From.Y, To.X, To.Y);
+        return;
+    }
+    const Move PlayedMove(FromKey, ToKey, bIsPromotion ? ToEnginePieceType(Promotion) : Cell::PieceType::none);
+    if (!ActiveBoard->is_legal_move(PlayedMove, MoverColor))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("MovePiece: (%d, %d) to (%d, %d) is not a legal move"), From.X, From.Y, To.X, To.Y);
+        return;
+    }
+
+    const bool bIsIrreversible = ActiveBoard->is_irreversible_move(PlayedMove);
+    const bool bIsWhiteMove = MoverColor == Cell::PieceColor::white;
+
+    StartPendingReplay();
+    ActiveReplay->record(Board::pack_move(PlayedMove));
+    ActiveBoard->make_move(PlayedMove);
+    InvalidateMoveCache();
+    ActiveGameHistory->push(ActiveBoard->get_hash(!bIsWhiteMove), bIsIrreversible);
+    bIsWhiteToMove = !bIsWhiteMove;
+    if (!bIsWhiteMove)
+    {
+        FullmoveNumber++;
+    }
+    LastMoveFromKey = PlayedMove.from_key;
+    LastMoveToKey = PlayedMove.to_key;
+}
+
+bool AChessGod::IsPromotionMove(FIntPoint From, FIntPoint To) const
+{
+    const int32 FromKey = ToCellKey(From);
+    const int32 ToKey = ToCellKey(To);
+    if (ActiveBoard == nullptr || Board::to_cell_index(FromKey) == -1 || Board::to_cell_index(ToKey) == -1)
+    {
+        return false;
+    }
+    return Board::is_promotion_move(ActiveBoard->board_map, FromKey, ToKey);
+}
+
+bool AChessGod::IsEnPassantMove(FIntPoint From, FIntPoint To, FIntPoint& CapturedCell) const
+{
+    const int32 FromKey = ToCellKey(From);
+    const int32 ToKey = ToCellKey(To);
+    if (ActiveBoard == nullptr || Board::to_cell_index(FromKey) == -1 || Board::to_cell_index(ToKey) == -1
+        || !Board::is_en_passant_move(ActiveBoard->board_map, FromKey, ToKey))
+    {
+        return false;
+    }
+    // the passed pawn stands right behind the cell, seen from the side taking it
+    const bool bIsWhiteMove = ActiveBoard->board_map[FromKey]->get_piece_color() == Cell::PieceColor::white;
+    CapturedCell = FIntPoint{To.X, bIsWhiteMove ? To.Y - 1 : To.Y + 1};
+    return true;
 }
 
 bool AChessGod::IsCellUnderAttack(FIntPoint InPosition)
 {
-    Position PiecePosition = Position{InPosition.X, InPosition.Y};
-    return ActiveBoard->can_be_captured(PiecePosition);
+    const int32 CellKey = ToCellKey(InPosition);
+    if (ActiveBoard == nullptr || Board::to_cell_index(CellKey) == -1)
+    {
+        return false;
+    }
+    return ActiveMoveCache->is_under_attack(*ActiveBoard, CellKey);
 }
 
 bool AChessGod::AreThereValidMovesForPlayer(bool IsWhitePlayer)
 {
-    return ActiveBoard->are_there_valid_moves(IsWhitePlayer ? Cell::PieceColor::white : Cell::PieceColor::black);
+    return ActiveMoveCache->has_valid_moves(*ActiveBoard, IsWhitePlayer ? Cell::PieceColor::white : Cell::PieceColor::black);
 }
 
 TArray<FIntPoint> AChessGod::GetValidMovesForPlayer(bool IsWhitePlayer)
 {
     TArray<FIntPoint> Result;
 
-    list<int32> MoveKeys = ActiveBoard->get_all_piece_move_keys(IsWhitePlayer ? Cell::PieceColor::white : Cell::PieceColor::black);
-    for (const auto& Move : MoveKeys)
+    const vector<int32>& MoveKeys = ActiveMoveCache->get_all_move_keys(*ActiveBoard, IsWhitePlayer ? Cell::PieceColor::white : Cell::PieceColor::black);
+    Result.Reserve(MoveKeys.size());
+    for (const int32 MoveKey : MoveKeys)
     {
-        Position MovePosition = ActiveBoard->to_position(Move);
+        Position MovePosition = ActiveBoard->to_position(MoveKey);
         Result.Add(FIntPoint{MovePosition.x, MovePosition.y});
     }
 
     return Result;
 }
 
+void AChessGod::GetHighlightMasks(FIntPoint SelectedCell, bool IsWhitePlayer, FCellMask (&Masks)[TileHighlightLayerCount]) const
+{
+    for (FCellMask& Mask : Masks)
+    {
+        Mask = FCellMask();
+    }
+    if (ActiveBoard == nullptr)
+    {
+        return;
+    }
+
+    const auto ToLayer = [](ETileHighlight Highlight)
+    {
+        return FMath::CountTrailingZeros(static_cast<uint32>(Highlight));
+    };
+
+    const int32 SelectedKey = ToCellKey(SelectedCell);
+    if (Board::to_cell_index(SelectedKey) != -1)
+    {
+        Masks[ToLayer(ETileHighlight::Selected)].Set(Board::to_cell_index(SelectedKey));
+        for (const int32 MoveKey : ActiveMoveCache->get_moves(*ActiveBoard, SelectedKey))
+        {
+            const bool bIsCapture = ActiveBoard->board_map[MoveKey]->has_piece() || Board::is_en_passant_move(ActiveBoard->board_map, SelectedKey, MoveKey);
+            Masks[ToLayer(bIsCapture ? ETileHighlight::Capture : ETileHighlight::Move)].Set(Board::to_cell_index(MoveKey));
+        }
+    }
+
+    const Cell::PieceColor PlayerColor = IsWhitePlayer ? Cell::PieceColor::white : Cell::PieceColor::black;
+    const Cell::PieceColor OpponentColor = IsWhitePlayer ? Cell::PieceColor::black : Cell::PieceColor::white;
+    const CellMask& OpponentAttacks = ActiveMoveCache->get_attacked_cells(*ActiveBoard, OpponentColor);
+    for (const int32 PieceKey : ActiveBoard->get_piece_keys(PlayerColor))
+    {
+        const int32 PieceIndex = Board::to_cell_index(PieceKey);
+        if (OpponentAttacks.test(PieceIndex))
+        {
+            Masks[ToLayer(ETileHighlight::Attacked)].Set(PieceIndex);
+        }
+    }
+
+    if (LastMoveFromKey != -1)
+    {
+        Masks[ToLayer(ETileHighlight::LastMove)].Set(Board::to_cell_index(LastMoveFromKey));
+        Masks[ToLayer(ETileHighlight::LastMove)].Set(Board::to_cell_index(LastMoveToKey));
+    }
+}
+
+uint16 AChessGod::PackMove(FIntPoint From, FIntPoint To, EPieceType Promotion) const
+{
+    const int32 FromKey = ToCellKey(From);
+    const int32 ToKey = ToCellKey(To);
+    if (ActiveBoard == nullptr || Board::to_cell_index(FromKey) == -1 || Board::to_cell_index(ToKey) == -1)
+    {
+        return 0;
+    }
+    const bool bIsPromotion = Board::is_promotion_move(ActiveBoard->board_map, FromKey, ToKey);
+    if (bIsPromotion && !IsPromotionPieceType(Promotion))
+    {
+        return 0;
+    }
+    return Board::pack_move(Move(FromKey, ToKey, bIsPromotion ? ToEnginePieceType(Promotion) : Cell::PieceType::none));
+}
+
+bool AChessGod::UnpackMove(uint16 PackedMove, FIntPoint& From, FIntPoint& To, EPieceType& Promotion) const
+{
+    if (ActiveBoard == nullptr)
+    {
+        return false;
+    }
+    const Move UnpackedMove = ActiveBoard->unpack_move(PackedMove);
+    if (!UnpackedMove.is_valid())
+    {
+        return false;
+    }
+    const Position FromPosition = ActiveBoard->to_position(UnpackedMove.from_key);
+    const Position ToPosition = ActiveBoard->to_position(UnpackedMove.to_key);
+    From = FIntPoint{FromPosition.x, FromPosition.y};
+    To = FIntPoint{ToPosition.x, ToPosition.y};
+    Promotion = ToPromotionPieceType(UnpackedMove.promotion);
+    return true;
+}
+
+bool AChessGod::IsLegalMove(bool IsWhitePlayer, FIntPoint From, FIntPoint To, EPieceType Promotion) const
+{
+    const int32 FromKey = ToCellKey(From);
+    const int32 ToKey = ToCellKey(To);
+    if (ActiveBoard == nullptr || Board::to_cell_index(FromKey) == -1 || Board::to_cell_index(ToKey) == -1)
+    {
+        return false;
+    }
+    const bool bIsPromotion = Board::is_promotion_move(ActiveBoard->board_map, FromKey, ToKey);
+    if (bIsPromotion && !IsPromotionPieceType(Promotion))
+    {
+        return false;
+    }
+    const Move CheckedMove(FromKey, ToKey, bIsPromotion ? ToEnginePieceType(Promotion) : Cell::PieceType::none);
+    return ActiveBoard->is_legal_move(CheckedMove, IsWhitePlayer ? Cell::PieceColor::white : Cell::PieceColor::black);
+}
+
+uint64 AChessGod::GetPositionHash() const
+{
+    return ActiveGameHistory != nullptr && !ActiveGameHistory->get_hashes().empty() ? ActiveGameHistory->get_hashes().back() : 0;
+}
+
+UHexaSaveGame* AChessGod::CreateMatchSave() const
+{
+    if (ActiveBoard == nullptr)
+    {
+        return nullptr;
+    }
+
+    UHexaSaveGame* Save = Cast<UHexaSaveGame>(UGameplayStatics::CreateSaveGameObject(UHexaSaveGame::StaticClass()));
+    Save->Notation = GetNotation();
+
+    const vector<uint64>& Hashes = ActiveGameHistory->get_hashes();
+    const int32 RecentCount = FMath::Min(static_cast<int32>(Hashes.size()), ActiveGameHistory->get_halfmove_clock() + 1);
+    Save->RecentHashes.Append(Hashes.data() + Hashes.size() - RecentCount, RecentCount);
+
+    StartPendingReplay();
+    const vector<uint8> ReplayBytes = ActiveReplay->to_bytes();
+    Save->Replay.Append(ReplayBytes.data(), ReplayBytes.size());
+
+    if (const UHexaGameInstance* GameInstance = GetGameInstance<UHexaGameInstance>())
+    {
+        Save->IsPlayingAgainstAI = GameInstance->IsPlayingAgainstAI;
+        Save->AIType = GameInstance->AIType;
+        Save->AIDifficulty = GameInstance->AIDifficulty;
+        Save->IsAIPlayingWhite = GameInstance->IsAIPlayingWhite;
+    }
+    Save->bPonder = MinimaxAIComponent->bPonder;
+    Save->bUseOpeningBook = MinimaxAIComponent->bUseOpeningBook;
+    return Save;
+}
+
+bool AChessGod::RestoreMatchSave(UHexaSaveGame* Save, TArray<FPieceInfo>& AddedPieces, TArray<FPieceInfo>& RemovedPieces)
+{
+    if (Save == nullptr)
+    {
+        return false;
+    }
+
+    TMap<FIntPoint, FPieceInfo> PiecesBefore;
+    for (const FPieceInfo& Piece : GetPieces())
+    {
+        PiecesBefore.Add(FIntPoint{Piece.X, Piece.Y}, Piece);
+    }
+
+    bool bIsSavedWhiteToMove = true;
+    const TArray<FBoardSetupConflict> Conflicts = SetupFromNotation(Save->Notation, bIsSavedWhiteToMove);
+    if (Conflicts.Num() > 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Can't restore the saved match: %s"), *Conflicts[0].Message);
+        return false;
+    }
+
+    // the saved hashes belong to this position unless the save was tampered with
+    if (Save->RecentHashes.Num() > 0 && Save->RecentHashes.Last() == GetPositionHash())
+    {
+        ActiveGameHistory->restore(vector<uint64>(Save->RecentHashes.GetData(), Save->RecentHashes.GetData() + Save->RecentHashes.Num()), ActiveGameHistory->get_halfmove_clock());
+    }
+    if (ActiveReplay->from_bytes(Save->Replay.GetData(), Save->Replay.Num()))
+    {
+        bIsReplayPending = false;
+    }
+    else
+    {
+        UE_LOG(LogTemp, Warning, TEXT("The saved match has no usable replay, recording starts over"));
+    }
+
+    if (UHexaGameInstance* GameInstance = GetGameInstance<UHexaGameInstance>())
+    {
+        GameInstance->IsPlayingAgainstAI = Save->IsPlayingAgainstAI;
+        GameInstance->AIType = Save->AIType;
+        GameInstance->AIDifficulty = Save->AIDifficulty;
+        GameInstance->IsAIPlayingWhite = Save->IsAIPlayingWhite;
+    }
+    MinimaxAIComponent->bPonder = Save->bPonder;
+    MinimaxAIComponent->bUseOpeningBook = Save->bUseOpeningBook;
+    MinimaxAIComponent->ResetContext();
+
+    AddedPieces.Reset();
+    RemovedPieces.Reset();
+    for (const FPieceInfo& Piece : GetPieces())
+    {
+        const FPieceInfo* PieceBefore = PiecesBefore.Find(FIntPoint{Piece.X, Piece.Y});
+        if (PieceBefore != nullptr && PieceBefore->TeamID == Piece.TeamID && PieceBefore->Type == Piece.Type)
+        {
+            PiecesBefore.Remove(FIntPoint{Piece.X, Piece.Y});
+        }
+        else
+        {
+            AddedPieces.Add(Piece);
+        }
+    }
+    PiecesBefore.GenerateValueArray(RemovedPieces);
+    return true;
+}
+
+bool AChessGod::SaveMatch(const FString& SlotName, int32 UserIndex)
+{
+    UHexaSaveGame* Save = CreateMatchSave();
+    return Save != nullptr && UGameplayStatics::SaveGameToSlot(Save, SlotName, UserIndex);
+}
+
+bool AChessGod::LoadMatch(const FString& SlotName, int32 UserIndex, TArray<FPieceInfo>& AddedPieces, TArray<FPieceInfo>& RemovedPieces)
+{
+    UHexaSaveGame* Save = Cast<UHexaSaveGame>(UGameplayStatics::LoadGameFromSlot(SlotName, UserIndex));
+    return RestoreMatchSave(Save, AddedPieces, RemovedPieces);
+}
+
+bool AChessGod::SaveReplay(const FString& Path)
+{
+    if (ActiveReplay == nullptr)
+    {
+        return false;
+    }
+    StartPendingReplay();
+    const vector<uint8> Bytes = ActiveReplay->to_bytes();
+    return FFileHelper::SaveArrayToFile(TArrayView<const uint8>(Bytes.data(), Bytes.size()), *Path);
+}
+
+bool AChessGod::LoadReplay(const FString& Path)
+{
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Can't open replay %s"), *Path);
+        return false;
+    }
+
+    Replay* NewReplay = new Replay();
+    ReplayPlayer* NewReplayPlayer = new ReplayPlayer();
+    string Error;
+    if (!NewReplay->from_bytes(Bytes.GetData(), Bytes.Num(), &Error) || !NewReplayPlayer->open(NewReplay, &Error))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Can't load replay %s: %s"), *Path, UTF8_TO_TCHAR(Error.c_str()));
+        delete NewReplayPlayer;
+        delete NewReplay;
+        return false;
+    }
+
+    delete LoadedReplayPlayer;
+    delete LoadedReplay;
+    LoadedReplay = NewReplay;
+    LoadedReplayPlayer = NewReplayPlayer;
+    return true;
+}
+
+bool AChessGod::SeekReplay(int32 Ply)
+{
+    if (LoadedReplayPlayer == nullptr)
+    {
+        return false;
+    }
+    if (ActiveBoard == nullptr)
+    {
+        CreateLogicalBoard();
+    }
+
+    string Error;
+    const bool bIsSeeked = LoadedReplayPlayer->seek(Ply, &Error);
+    if (!bIsSeeked)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Replay stopped at ply %d: %s"), LoadedReplayPlayer->get_ply(), UTF8_TO_TCHAR(Error.c_str()));
+    }
+    ActiveBoard->copy_pieces_from(LoadedReplayPlayer->get_board());
+    InvalidateMoveCache();
+    ResetGameHistory(LoadedReplayPlayer->is_white_to_move(), 0, LoadedReplayPlayer->get_fullmove_number());
+    return bIsSeeked;
+}
+
+int32 AChessGod::GetReplayPlyCount() const
+{
+    return LoadedReplay != nullptr ? LoadedReplay->get_ply_count() : 0;
+}
+
+int32 AChessGod::GetReplayPly() const
+{
+    return LoadedReplayPlayer != nullptr ? LoadedReplayPlayer->get_ply() : 0;
+}
+
+TArray<FPieceInfo> AChessGod::GetPieces() const
+{
+    TArray<FPieceInfo> Pieces;
+    if (ActiveBoard == nullptr)
+    {
+        return Pieces;
+    }
+    for (const auto& [Key, PieceCell] : ActiveBoard->board_map)
+    {
+        if (!PieceCell->has_piece())
+        {
+            continue;
+        }
+        const Position PiecePosition = ActiveBoard->to_position(Key);
+        FPieceInfo& Piece = Pieces.AddDefaulted_GetRef();
+        Piece.X = PiecePosition.x;
+        Piece.Y = PiecePosition.y;
+        Piece.TeamID = PieceCell->get_piece_color() == Cell::PieceColor::white ? 0 : 1;
+        Piece.Type = ToPieceType(PieceCell->get_piece_type());
+    }
+    return Pieces;
+}
+
+int32 AChessGod::GetRepetitionCount() const
+{
+    return ActiveGameHistory != nullptr ? ActiveGameHistory->get_repetition_count() : 0;
+}
+
+bool AChessGod::IsDrawByRepetition() const
+{
+    return ActiveGameHistory != nullptr && ActiveGameHistory->is_threefold_repetition();
+}
+
+int32 AChessGod::GetHalfmoveClock() const
+{
+    return ActiveGameHistory != nullptr ? ActiveGameHistory->get_halfmove_clock() : 0;
+}
+
+bool AChessGod::IsFiftyMoveDraw() const
+{
+    return ActiveGameHistory != nullptr && ActiveGameHistory->is_fifty_move_draw();
+}
+
 TArray<FIntPoint> AChessGod::MakeAIMove(bool IsWhiteAI, EAIType AIType, EAIDifficulty AIDifficulty)
 {
     TArray<FIntPoint> Result;
@@ -149,7 +701,7 @@ TArray<FIntPoint> AChessGod::CalculateRandomAIMove(bool IsWhiteAI)
     while (!foundValidMove) {
         int32 RandomIndex = FMath::RandRange(0, PieceKeys.size() - 1);
         int32 RandomPieceKey = *std::next(PieceKeys.begin(), RandomIndex);
-        auto PieceMoves = ActiveBoard->get_valid_moves(RandomPieceKey);
+        const auto& PieceMoves = ActiveMoveCache->get_moves(*ActiveBoard, RandomPieceKey);
         if (PieceMoves.size() > 0)
         {
             foundValidMove = true;
@@ -183,7 +735,7 @@ TArray<FIntPoint> AChessGod::CalculateMinMaxAIMove(bool IsWhiteAI, EAIDifficulty
 
     TArray<FIntPoint> Result;
 
-    MinimaxAIComponent->StartCalculatingMove(ActiveBoard, IsWhiteAI, Depth);
+    MinimaxAIComponent->StartCalculatingMove(ActiveBoard, *ActiveGameHistory, IsWhiteAI, Depth);
 
     return Result;
 }
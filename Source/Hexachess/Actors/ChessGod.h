@@ -3,12 +3,21 @@
 #include "CoreMinimal.h"
 
 #include "Chess/MinimaxAI.h"
+#include "Types/AISearchStats.h"
+#include "Types/BoardSetupConflict.h"
+#include "Types/CellMask.h"
+#include "Types/TileHighlight.h"
 #include "Types/PieceInfo.h"
 #include "Types/AIType.h"
 
 #include "ChessGod.generated.h"
 
 class Board;
+class GameHistory;
+class MoveCache;
+class Replay;
+class ReplayPlayer;
+class UHexaSaveGame;
 
 
 UCLASS(Blueprintable, BlueprintType)
@@ -42,11 +51,45 @@ public:
 	UFUNCTION(BlueprintCallable)
 	virtual void RegisterPiece(FPieceInfo PieceInfo);
 
+	/*
+	 * Replaces every piece on the logical board in one call, creating the board if needed.
+	 * Returns the conflicts found; the board is only changed when there are none.
+	 */
+	UFUNCTION(BlueprintCallable)
+	virtual TArray<FBoardSetupConflict> SetupBoard(const TArray<FPieceInfo>& Pieces);
+
+	/*
+	 * Same as SetupBoard for a position in the engine notation (Chess/Notation.h).
+	 */
+	UFUNCTION(BlueprintCallable)
+	virtual TArray<FBoardSetupConflict> SetupFromNotation(const FString& Notation, bool& IsWhiteToMove);
+
+	/*
+	 * The current position in the engine notation, the counterpart of SetupFromNotation.
+	 * The side to move and the move counters are the ones tracked by the game.
+	 */
+	UFUNCTION(BlueprintPure)
+	FString GetNotation() const;
+
 	UFUNCTION(BlueprintCallable)
 	virtual TArray<FIntPoint> GetMovesForCell(FIntPoint InPosition);
 
+	/*
+	 * Promotion is the piece a pawn reaching the last cell of its column becomes,
+	 * a queen, rook, bishop or knight, ignored for every other move. An en passant
+	 * capture removes the passed pawn. Moves of the side not to move, or that aren't
+	 * legal for the piece on From, are logged and ignored.
+	 */
 	UFUNCTION(BlueprintCallable )
-	virtual void MovePiece(FIntPoint From, FIntPoint To);
+	virtual void MovePiece(FIntPoint From, FIntPoint To, EPieceType Promotion = EPieceType::Queen);
+
+	// true when MovePiece(From, To) would promote, so the player can pick the piece first
+	UFUNCTION(BlueprintPure)
+	bool IsPromotionMove(FIntPoint From, FIntPoint To) const;
+
+	// true when MovePiece(From, To) takes en passant, CapturedCell is where the taken pawn stands
+	UFUNCTION(BlueprintPure)
+	bool IsEnPassantMove(FIntPoint From, FIntPoint To, FIntPoint& CapturedCell) const;
 
 	UFUNCTION(BlueprintCallable)
 	virtual bool IsCellUnderAttack(FIntPoint InPosition);
@@ -57,6 +100,95 @@ public:
 	UFUNCTION(BlueprintCallable)
 	virtual TArray<FIntPoint> GetValidMovesForPlayer(bool IsWhitePlayer);
 
+	/*
+	 * The tiles of each ETileHighlight layer for AHexaGrid::ApplyHighlightMasks: the selected
+	 * cell, the moves and captures of its piece, the player's pieces under attack and the last move.
+	 */
+	void GetHighlightMasks(FIntPoint SelectedCell, bool IsWhitePlayer, FCellMask (&Masks)[TileHighlightLayerCount]) const;
+
+	// network helpers, see AHexaGameState
+
+	// the two byte form of a move (Board::pack_move), 0 when From or To is off the board
+	// or a promotion names a piece a pawn can't become
+	uint16 PackMove(FIntPoint From, FIntPoint To, EPieceType Promotion) const;
+
+	// reverses PackMove for the current board, false for a packed move that can't be a move
+	bool UnpackMove(uint16 PackedMove, FIntPoint& From, FIntPoint& To, EPieceType& Promotion) const;
+
+	// a legal move of the given player, Promotion is ignored for moves that don't promote
+	UFUNCTION(BlueprintPure)
+	bool IsLegalMove(bool IsWhitePlayer, FIntPoint From, FIntPoint To, EPieceType Promotion) const;
+
+	// Zobrist hash of the current position as recorded by the game history
+	uint64 GetPositionHash() const;
+
+	// draw rules, tracked by MovePiece since the last setup
+
+	// how often the current position has occurred, itself included
+	UFUNCTION(BlueprintPure)
+	int32 GetRepetitionCount() const;
+
+	UFUNCTION(BlueprintPure)
+	bool IsDrawByRepetition() const;
+
+	// plies since the last capture or pawn move
+	UFUNCTION(BlueprintPure)
+	int32 GetHalfmoveClock() const;
+
+	UFUNCTION(BlueprintPure)
+	bool IsFiftyMoveDraw() const;
+
+	// save games
+
+	// side to move, as given by the last setup and flipped by MovePiece
+	UFUNCTION(BlueprintPure)
+	bool IsWhiteToMove() const { return bIsWhiteToMove; }
+
+	// snapshot of the match and the AI settings of the game instance, nullptr without a board
+	UFUNCTION(BlueprintCallable)
+	UHexaSaveGame* CreateMatchSave() const;
+
+	/*
+	 * Puts the match of a save back in one call. Only AddedPieces and RemovedPieces
+	 * differ from the board before, so only their actors need to change.
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool RestoreMatchSave(UHexaSaveGame* Save, TArray<FPieceInfo>& AddedPieces, TArray<FPieceInfo>& RemovedPieces);
+
+	UFUNCTION(BlueprintCallable)
+	bool SaveMatch(const FString& SlotName, int32 UserIndex = 0);
+
+	UFUNCTION(BlueprintCallable)
+	bool LoadMatch(const FString& SlotName, int32 UserIndex, TArray<FPieceInfo>& AddedPieces, TArray<FPieceInfo>& RemovedPieces);
+
+	// replays, recorded by MovePiece from the last setup on (Chess/Replay.h)
+
+	// writes the moves played since the last setup, with their timestamps
+	UFUNCTION(BlueprintCallable)
+	bool SaveReplay(const FString& Path);
+
+	// opens a replay for playback at ply 0, the current game is left as is until SeekReplay
+	UFUNCTION(BlueprintCallable)
+	bool LoadReplay(const FString& Path);
+
+	/*
+	 * Sets the board to the loaded replay after the given number of plies, replaying the
+	 * moves on the engine only. Rebuild the pieces from GetPieces afterwards. The game
+	 * history and recording start over from there, so play can go on from any ply.
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool SeekReplay(int32 Ply);
+
+	UFUNCTION(BlueprintPure)
+	int32 GetReplayPlyCount() const;
+
+	UFUNCTION(BlueprintPure)
+	int32 GetReplayPly() const;
+
+	// every piece on the logical board
+	UFUNCTION(BlueprintPure)
+	TArray<FPieceInfo> GetPieces() const;
+
 	// ai logic
 
 	/*
@@ -72,11 +204,48 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FOnAIFinishedCalculatingMove OnAIFinishedCalculatingMove;
 
+	// piece chosen by the AI when its last move is a promotion, set before OnAIFinishedCalculatingMove
+	UPROPERTY(BlueprintReadOnly)
+	EPieceType LastAIPromotion = EPieceType::Queen;
+
+	// broadcast right before OnAIFinishedCalculatingMove for minimax moves
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAISearchFinished, FAISearchStats, Stats);
+
+	UPROPERTY(BlueprintAssignable)
+	FOnAISearchFinished OnAISearchFinished;
+
 private:
 
 	TArray<FIntPoint> CalculateRandomAIMove(bool IsWhiteAI);
 	TArray<FIntPoint> CalculateCopycatAIMove(bool IsWhiteAI);
 	TArray<FIntPoint> CalculateMinMaxAIMove(bool IsWhiteAI, EAIDifficulty AIDifficulty);
 
+	// serves the move and attack queries above, invalidated on every board change
+	void InvalidateMoveCache();
+
+	// starts the game history over from the current board, the replay follows with StartPendingReplay
+	void ResetGameHistory(bool IsWhiteToMove, int32 HalfmoveClock, int32 InFullmoveNumber);
+
+	// Starts recording the replay from the board of the last ResetGameHistory. Put
+	// off until the replay is needed, since a board set up piece by piece with
+	// RegisterPiece resets the history once per piece.
+	void StartPendingReplay() const;
+
 	Board* ActiveBoard = nullptr;
+	MoveCache* ActiveMoveCache = nullptr;
+	GameHistory* ActiveGameHistory = nullptr;
+	Replay* ActiveReplay = nullptr;
+	mutable bool bIsReplayPending = false;
+	// FPlatformTime::Seconds of the reset the pending replay starts from, the move times count from it
+	double ReplayPendingSince = 0.0;
+	bool bIsWhiteToMove = true;
+	// counted up after every black move, as in the notation
+	int32 FullmoveNumber = 1;
+	// cell keys of the last MovePiece, -1 after a setup
+	int32 LastMoveFromKey = -1;
+	int32 LastMoveToKey = -1;
+
+	// playback, kept across games until the next LoadReplay
+	Replay* LoadedReplay = nullptr;
+	ReplayPlayer* LoadedReplayPlayer = nullptr;
 };
\ No newline at end of file
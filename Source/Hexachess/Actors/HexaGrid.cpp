@@ -0,0 +1,218 @@
+#include "HexaGrid.h"
+
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+
+#include "Actors/ChessGod.h"
+#include "Chess/HexCoordinates.h"
+
+
+namespace
+{
+    int32 ToCellIndex(FIntPoint Cell)
+    {
+        if (Cell.X < 0 || Cell.Y < 0 || Cell.Y > 0xff)
+        {
+            return -1;
+        }
+        return HexCoordinates::to_index((Cell.X << 8) + Cell.Y);
+    }
+
+    // the three colours of the Glinski board, neighbouring cells never share one
+    int32 GetTileShade(int32 Index)
+    {
+        const AxialCoord Axial = HexCoordinates::to_axial(Index);
+        return ((Axial.q - Axial.r) % 3 + 3) % 3;
+    }
+}
+
+AHexaGrid::AHexaGrid()
+{
+    PrimaryActorTick.bCanEverTick = false;
+
+    Tiles = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Tiles"));
+    Tiles->NumCustomDataFloats = 2;
+    Tiles->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    RootComponent = Tiles;
+}
+
+void AHexaGrid::OnConstruction(const FTransform& Transform)
+{
+    Super::OnConstruction(Transform);
+
+    if (TileMesh != nullptr)
+    {
+        GenerateGrid();
+    }
+}
+
+void AHexaGrid::GenerateGrid()
+{
+    Tiles->ClearInstances();
+    Tiles->SetStaticMesh(TileMesh);
+    Tiles->NumCustomDataFloats = 2;
+    Tiles->SetCollisionEnabled(bEnableTileCollision ? ECollisionEnabled::QueryOnly : ECollisionEnabled::NoCollision);
+
+    const float Scale = TileMeshRadius > 0.0f ? CellRadius / TileMeshRadius : 1.0f;
+    TArray<FTransform> Transforms;
+    Transforms.Reserve(HexCoordinates::cell_count);
+    for (int32 Index = 0; Index < HexCoordinates::cell_count; Index++)
+    {
+        const WorldCoord World = HexCoordinates::to_world(Index);
+        Transforms.Add(FTransform(FRotator::ZeroRotator, FVector(World.x * CellRadius, World.y * CellRadius, 0.0f), FVector(Scale)));
+    }
+    Tiles->AddInstances(Transforms, false);
+
+    for (int32 Index = 0; Index < HexCoordinates::cell_count; Index++)
+    {
+        Tiles->SetCustomDataValue(Index, ShadeDataIndex, GetTileShade(Index), false);
+    }
+    for (FCellMask& Mask : HighlightMasks)
+    {
+        Mask = FCellMask();
+    }
+    Tiles->MarkRenderStateDirty();
+}
+
+void AHexaGrid::SetTileHighlight(FIntPoint Cell, int32 Highlight)
+{
+    const int32 Index = ToCellIndex(Cell);
+    if (Index == -1)
+    {
+        return;
+    }
+    FCellMask Masks[TileHighlightLayerCount];
+    for (int32 Layer = 0; Layer < TileHighlightLayerCount; Layer++)
+    {
+        Masks[Layer] = HighlightMasks[Layer];
+        if (Highlight & (1 << Layer))
+        {
+            Masks[Layer].Set(Index);
+        }
+        else
+        {
+            Masks[Layer].Clear(Index);
+        }
+    }
+    ApplyHighlightMasks(Masks);
+}
+
+int32 AHexaGrid::GetTileHighlight(FIntPoint Cell) const
+{
+    const int32 Index = ToCellIndex(Cell);
+    int32 Highlight = 0;
+    for (int32 Layer = 0; Index != -1 && Layer < TileHighlightLayerCount; Layer++)
+    {
+        Highlight |= HighlightMasks[Layer].Test(Index) ? 1 << Layer : 0;
+    }
+    return Highlight;
+}
+
+void AHexaGrid::ClearTileHighlights()
+{
+    const FCellMask NoMasks[TileHighlightLayerCount];
+    ApplyHighlightMasks(NoMasks);
+}
+
+void AHexaGrid::ShowHighlights(AChessGod* ChessGod, FIntPoint SelectedCell, bool IsWhitePlayer)
+{
+    if (ChessGod == nullptr)
+    {
+        return;
+    }
+    FCellMask Masks[TileHighlightLayerCount];
+    ChessGod->GetHighlightMasks(SelectedCell, IsWhitePlayer, Masks);
+    ApplyHighlightMasks(Masks);
+}
+
+void AHexaGrid::ApplyHighlightMasks(const FCellMask (&Masks)[TileHighlightLayerCount])
+{
+    FCellMask Changed;
+    for (int32 Layer = 0; Layer < TileHighlightLayerCount; Layer++)
+    {
+        Changed |= HighlightMasks[Layer] ^ Masks[Layer];
+        HighlightMasks[Layer] = Masks[Layer];
+    }
+    if (Changed.IsEmpty() || Tiles->GetInstanceCount() != HexCoordinates::cell_count)
+    {
+        return;
+    }
+
+    Changed.ForEach([this](int32 Index)
+    {
+        int32 Highlight = 0;
+        for (int32 Layer = 0; Layer < TileHighlightLayerCount; Layer++)
+        {
+            Highlight |= HighlightMasks[Layer].Test(Index) ? 1 << Layer : 0;
+        }
+        Tiles->SetCustomDataValue(Index, HighlightDataIndex, Highlight, false);
+    });
+    Tiles->MarkRenderStateDirty();
+}
+
+FVector AHexaGrid::GetCellLocation(FIntPoint Cell) const
+{
+    const int32 Index = ToCellIndex(Cell);
+    if (Index == -1)
+    {
+        return GetActorLocation();
+    }
+    const WorldCoord World = HexCoordinates::to_world(Index);
+    return GetActorTransform().TransformPosition(FVector(World.x * CellRadius, World.y * CellRadius, 0.0f));
+}
+
+bool AHexaGrid::GetCellAtLocation(FVector Location, FIntPoint& Cell) const
+{
+    const FVector Local = GetActorTransform().InverseTransformPosition(Location) / CellRadius;
+    const int32 Index = HexCoordinates::from_world(Local.X, Local.Y);
+    if (Index == -1)
+    {
+        return false;
+    }
+    const int32 Key = HexCoordinates::to_key(Index);
+    Cell = FIntPoint{Key >> 8, Key & 0xff};
+    return true;
+}
+
+bool AHexaGrid::GetCellAlongRay(FVector Origin, FVector Direction, FIntPoint& Cell, int32& CellKey) const
+{
+    const FVector PlaneNormal = GetActorUpVector();
+    const float Facing = FVector::DotProduct(Direction, PlaneNormal);
+    if (FMath::IsNearlyZero(Facing))
+    {
+        return false;
+    }
+    const float Distance = FVector::DotProduct(GetActorLocation() - Origin, PlaneNormal) / Facing;
+    if (Distance < 0.0f)
+    {
+        return false;
+    }
+    if (!GetCellAtLocation(Origin + Direction * Distance, Cell))
+    {
+        return false;
+    }
+    CellKey = (Cell.X << 8) + Cell.Y;
+    return true;
+}
+
+bool AHexaGrid::GetCellUnderCursor(APlayerController* PlayerController, FIntPoint& Cell, int32& CellKey) const
+{
+    FVector Origin;
+    FVector Direction;
+    if (PlayerController == nullptr || !PlayerController->DeprojectMousePositionToWorld(Origin, Direction))
+    {
+        return false;
+    }
+    return GetCellAlongRay(Origin, Direction, Cell, CellKey);
+}
+
+int32 AHexaGrid::GetCellDistance(FIntPoint From, FIntPoint To)
+{
+    const int32 FromIndex = ToCellIndex(From);
+    const int32 ToIndex = ToCellIndex(To);
+    if (FromIndex == -1 || ToIndex == -1)
+    {
+        return -1;
+    }
+    return HexCoordinates::get_distance(FromIndex, ToIndex);
+}
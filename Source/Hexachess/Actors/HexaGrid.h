@@ -2,22 +2,114 @@
 
 #include <CoreMinimal.h>
 
+#include "Types/CellMask.h"
+#include "Types/TileHighlight.h"
+
 #include "HexaGrid.generated.h"
 
+class AChessGod;
+class UHierarchicalInstancedStaticMeshComponent;
+
+
+/*
+ * The board tiles, drawn as the instances of one hierarchical instanced
+ * static mesh. Instance i is the cell with index i (Chess/HexCoordinates.h)
+ * and carries two custom data floats for its material: the highlight flags
+ * (ETileHighlight) and the tile shade, 0 to 2.
+ */
 UCLASS()
 class AHexaGrid : public AActor
 {
     GENERATED_BODY()
 
+    AHexaGrid();
+
 public:
 
+    static const int32 HighlightDataIndex = 0;
+    static const int32 ShadeDataIndex = 1;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+    UHierarchicalInstancedStaticMeshComponent* Tiles = nullptr;
+
+    // GenerateGrid runs on construction once it is set
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+    UStaticMesh* TileMesh = nullptr;
+
+    // CellRadius of the tile mesh as modelled, tiles are scaled to fit CellRadius
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+    float TileMeshRadius = 100.0f;
+
+    // off by default, picking goes through GetCellUnderCursor; only for Blueprints still tracing against tiles
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+    bool bEnableTileCollision = false;
+
+    virtual void OnConstruction(const FTransform& Transform) override;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
     int32 Width = 22;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
     int32 Height = 22;
 
+    // distance from the center of a cell to its corners, in actor space
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+    float CellRadius = 100.0f;
+
+    // one tile instance per cell, replacing the previous ones
     UFUNCTION(BlueprintCallable)
-    virtual void GenerateGrid() {}
+    virtual void GenerateGrid();
+
+    // the highlight flags of a tile, ignored for cells off the board
+    UFUNCTION(BlueprintCallable)
+    void SetTileHighlight(FIntPoint Cell, UPARAM(meta = (Bitmask, BitmaskEnum = "/Script/Hexachess.ETileHighlight")) int32 Highlight);
+
+    UFUNCTION(BlueprintPure)
+    int32 GetTileHighlight(FIntPoint Cell) const;
+
+    // every tile back to no highlight
+    UFUNCTION(BlueprintCallable)
+    void ClearTileHighlights();
+
+    /*
+     * Highlights the selected cell, its moves and captures, the player's pieces under
+     * attack and the last move, in one call. Only tiles whose flags change are touched.
+     */
+    UFUNCTION(BlueprintCallable)
+    void ShowHighlights(AChessGod* ChessGod, FIntPoint SelectedCell, bool IsWhitePlayer);
+
+    // sets every layer at once from its mask, touching only the tiles where a layer changed
+    void ApplyHighlightMasks(const FCellMask (&Masks)[TileHighlightLayerCount]);
+
+    /*
+     * Cell coordinates are the engine ones (X file, Y cell within the file, see Chess/HexCoordinates.h).
+     * The center cell sits on the actor, files run along the actor's X axis and each file up its Y axis.
+     */
+    UFUNCTION(BlueprintPure)
+    FVector GetCellLocation(FIntPoint Cell) const;
+
+    // the cell under a world location, false when it is off the board
+    UFUNCTION(BlueprintPure)
+    bool GetCellAtLocation(FVector Location, FIntPoint& Cell) const;
+
+    /*
+     * The cell a ray hits on the board plane, worked out without any physics trace.
+     * CellKey is the engine key ((X << 8) + Y). False when the ray misses the board.
+     */
+    UFUNCTION(BlueprintPure)
+    bool GetCellAlongRay(FVector Origin, FVector Direction, FIntPoint& Cell, int32& CellKey) const;
+
+    // GetCellAlongRay for the mouse cursor of a player
+    UFUNCTION(BlueprintPure)
+    bool GetCellUnderCursor(APlayerController* PlayerController, FIntPoint& Cell, int32& CellKey) const;
+
+    // number of king steps between two cells, -1 when either is off the board
+    UFUNCTION(BlueprintPure)
+    static int32 GetCellDistance(FIntPoint From, FIntPoint To);
+
+private:
+
+    // the tiles of each highlight layer as last written to the instances
+    FCellMask HighlightMasks[TileHighlightLayerCount];
 
 };
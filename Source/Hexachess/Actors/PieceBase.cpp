@@ -1,6 +1,38 @@
 #include "PieceBase.h"
 
+#include <GeometryCollection/GeometryCollectionComponent.h>
+
 APieceBase::APieceBase()
 {
     PrimaryActorTick.bCanEverTick = false;
 }
+
+void APieceBase::ActivatePiece(EPieceType NewType, int32 NewColorID, FIntPoint Cell, const FVector& Location)
+{
+    Type = NewType;
+    GridX = Cell.X;
+    GridY = Cell.Y;
+    bIsPieceActive = true;
+
+    SetActorLocation(Location, false, nullptr, ETeleportType::ResetPhysics);
+    SetActorHiddenInGame(false);
+    SetActorEnableCollision(true);
+    ColorID = NewColorID;
+    SetColor(NewColorID);
+    OnActivated();
+}
+
+void APieceBase::DeactivatePiece()
+{
+    bIsPieceActive = false;
+
+    SetActorHiddenInGame(true);
+    SetActorEnableCollision(false);
+    if (UGeometryCollectionComponent* Collection = GetGeometryCollectionComponent())
+    {
+        // back to the rest collection, the fragments of a Kill() included
+        Collection->SetSimulatePhysics(false);
+        Collection->RecreatePhysicsState();
+    }
+    OnDeactivated();
+}
@@ -30,8 +30,9 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
     int32 GridY = 0;
 
+    // overrides call this too, APiecePool finds pieces by their cell
     UFUNCTION(BlueprintCallable)
-    virtual void Move(int32 NewGridX, int32 NewGridY) {}
+    virtual void Move(int32 NewGridX, int32 NewGridY) { GridX = NewGridX; GridY = NewGridY; }
 
     UFUNCTION(BlueprintCallable)
     virtual void Kill() {}
@@ -39,4 +40,31 @@ public:
     UFUNCTION(BlueprintCallable)
     virtual void SetColor(int32 NewColorID) {}
 
+    // pooling, see APiecePool
+
+    /*
+     * Takes the piece out of the pool onto a cell: shows it, turns its collision on and
+     * calls SetColor and OnActivated so Blueprints can restyle it for the new type.
+     */
+    virtual void ActivatePiece(EPieceType NewType, int32 NewColorID, FIntPoint Cell, const FVector& Location);
+
+    /*
+     * Hides the piece and puts a shattered geometry collection back together, keeping
+     * the component and its collection so the next activation allocates nothing.
+     */
+    virtual void DeactivatePiece();
+
+    UFUNCTION(BlueprintPure)
+    bool IsPieceActive() const { return bIsPieceActive; }
+
+    UFUNCTION(BlueprintImplementableEvent)
+    void OnActivated();
+
+    UFUNCTION(BlueprintImplementableEvent)
+    void OnDeactivated();
+
+private:
+
+    bool bIsPieceActive = true;
+
 };
@@ -0,0 +1,145 @@
+#include "PiecePool.h"
+
+#include "HexaGrid.h"
+#include "PieceBase.h"
+
+
+namespace
+{
+    // one side of the Glinski set
+    const TPair<EPieceType, int32> PieceSet[] = {
+        {EPieceType::King, 1},
+        {EPieceType::Queen, 1},
+        {EPieceType::Bishop, 3},
+        {EPieceType::Knight, 2},
+        {EPieceType::Rook, 2},
+        {EPieceType::Pawn, 9}
+    };
+}
+
+APiecePool::APiecePool()
+{
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+}
+
+void APiecePool::BeginPlay()
+{
+    Super::BeginPlay();
+
+    for (int32 ColorID = 0; ColorID < 2; ColorID++)
+    {
+        for (const TPair<EPieceType, int32>& Kind : PieceSet)
+        {
+            const int32 Count = Kind.Value + (Kind.Key == EPieceType::Queen ? ExtraQueens : 0);
+            for (int32 i = FreePieces[ToPoolIndex(Kind.Key, ColorID)].Num(); i < Count; i++)
+            {
+                PendingSpawns.Add(FPendingSpawn{Kind.Key, ColorID});
+            }
+        }
+    }
+    SetActorTickEnabled(PendingSpawns.Num() > 0);
+}
+
+void APiecePool::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    for (int32 i = 0; i < SpawnsPerFrame && PendingSpawns.Num() > 0; i++)
+    {
+        const FPendingSpawn Spawn = PendingSpawns.Pop(false);
+        if (APieceBase* Piece = SpawnPiece(Spawn.Type, Spawn.ColorID))
+        {
+            FreePieces[ToPoolIndex(Spawn.Type, Spawn.ColorID)].Add(Piece);
+        }
+    }
+    if (PendingSpawns.Num() == 0)
+    {
+        SetActorTickEnabled(false);
+    }
+}
+
+APieceBase* APiecePool::AcquirePiece(EPieceType Type, int32 ColorID, FIntPoint Cell)
+{
+    TArray<APieceBase*>& Free = FreePieces[ToPoolIndex(Type, ColorID)];
+    APieceBase* Piece = Free.Num() > 0 ? Free.Pop(false) : SpawnPiece(Type, ColorID);
+    if (Piece == nullptr)
+    {
+        return nullptr;
+    }
+    Piece->ActivatePiece(Type, ColorID, Cell, GetCellLocation(Cell));
+    ActivePieces.Add(Piece);
+    return Piece;
+}
+
+void APiecePool::ReleasePiece(APieceBase* Piece)
+{
+    if (Piece == nullptr || ActivePieces.RemoveSwap(Piece, false) == 0)
+    {
+        return;
+    }
+    Piece->DeactivatePiece();
+    FreePieces[ToPoolIndex(Piece->Type, Piece->ColorID)].Add(Piece);
+}
+
+void APiecePool::ReleaseAllPieces()
+{
+    while (ActivePieces.Num() > 0)
+    {
+        ReleasePiece(ActivePieces.Last());
+    }
+}
+
+APieceBase* APiecePool::GetPieceAt(FIntPoint Cell) const
+{
+    // pieces keep their cell up to date through Move()
+    for (APieceBase* Piece : ActivePieces)
+    {
+        if (Piece->GridX == Cell.X && Piece->GridY == Cell.Y)
+        {
+            return Piece;
+        }
+    }
+    return nullptr;
+}
+
+void APiecePool::ApplyPieceChanges(const TArray<FPieceInfo>& AddedPieces, const TArray<FPieceInfo>& RemovedPieces)
+{
+    for (const FPieceInfo& Piece : RemovedPieces)
+    {
+        ReleasePiece(GetPieceAt(FIntPoint{Piece.X, Piece.Y}));
+    }
+    for (const FPieceInfo& Piece : AddedPieces)
+    {
+        AcquirePiece(Piece.Type, Piece.TeamID, FIntPoint{Piece.X, Piece.Y});
+    }
+}
+
+APieceBase* APiecePool::SpawnPiece(EPieceType Type, int32 ColorID)
+{
+    const TSubclassOf<APieceBase>* PieceClass = PieceClasses.Find(Type);
+    if (PieceClass == nullptr || *PieceClass == nullptr)
+    {
+        return nullptr;
+    }
+
+    FActorSpawnParameters SpawnParameters;
+    SpawnParameters.Owner = this;
+    SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    APieceBase* Piece = GetWorld()->SpawnActor<APieceBase>(*PieceClass, GetActorTransform(), SpawnParameters);
+    if (Piece == nullptr)
+    {
+        return nullptr;
+    }
+    Piece->Type = Type;
+    Piece->ColorID = ColorID;
+    Piece->SetColor(ColorID);
+    Piece->DeactivatePiece();
+    Pieces.Add(Piece);
+    return Piece;
+}
+
+FVector APiecePool::GetCellLocation(FIntPoint Cell) const
+{
+    return Grid != nullptr ? Grid->GetCellLocation(Cell) : GetActorLocation();
+}
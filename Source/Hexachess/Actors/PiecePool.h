@@ -0,0 +1,97 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include "Types/PieceInfo.h"
+#include "Types/PieceType.h"
+
+#include "PiecePool.generated.h"
+
+class AHexaGrid;
+class APieceBase;
+
+
+/*
+ * Keeps every piece actor of the level alive and hands them out. The pieces
+ * of both full sets, plus ExtraQueens per colour for promotions, are spawned
+ * a few per frame after BeginPlay; captures, promotions and restarts then
+ * only hide and show actors. A piece is spawned on demand when the pool of
+ * its kind runs dry.
+ */
+UCLASS()
+class APiecePool : public AActor
+{
+    GENERATED_BODY()
+
+    APiecePool();
+
+public:
+
+    // the actor class of each piece type, shared by both colours
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+    TMap<EPieceType, TSubclassOf<APieceBase>> PieceClasses;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+    int32 ExtraQueens = 1;
+
+    // spawned per frame while filling the pool
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+    int32 SpawnsPerFrame = 4;
+
+    // places the pieces on its cells, the pool's location otherwise
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+    AHexaGrid* Grid = nullptr;
+
+    virtual void BeginPlay() override;
+    virtual void Tick(float DeltaSeconds) override;
+
+    // a piece of the kind standing on the cell, nullptr when there's no class for the type
+    UFUNCTION(BlueprintCallable)
+    APieceBase* AcquirePiece(EPieceType Type, int32 ColorID, FIntPoint Cell);
+
+    UFUNCTION(BlueprintCallable)
+    void ReleasePiece(APieceBase* Piece);
+
+    // for a restart, every piece goes back to the pool
+    UFUNCTION(BlueprintCallable)
+    void ReleaseAllPieces();
+
+    // the active piece on the cell, nullptr when it's empty
+    UFUNCTION(BlueprintPure)
+    APieceBase* GetPieceAt(FIntPoint Cell) const;
+
+    // releases the removed pieces first so their actors serve the added ones, as returned by AChessGod::RestoreMatchSave
+    UFUNCTION(BlueprintCallable)
+    void ApplyPieceChanges(const TArray<FPieceInfo>& AddedPieces, const TArray<FPieceInfo>& RemovedPieces);
+
+    UFUNCTION(BlueprintPure)
+    bool IsFilled() const { return PendingSpawns.Num() == 0; }
+
+private:
+
+    struct FPendingSpawn
+    {
+        EPieceType Type;
+        int32 ColorID;
+    };
+
+    static int32 ToPoolIndex(EPieceType Type, int32 ColorID)
+    {
+        return static_cast<int32>(Type) * 2 + (ColorID == 0 ? 0 : 1);
+    }
+
+    // hidden, inactive and not yet in a free list; nullptr without a class for the type
+    APieceBase* SpawnPiece(EPieceType Type, int32 ColorID);
+
+    FVector GetCellLocation(FIntPoint Cell) const;
+
+    // keeps every piece alive, active or not
+    UPROPERTY()
+    TArray<APieceBase*> Pieces;
+
+    // per piece type and colour, see ToPoolIndex
+    TArray<APieceBase*> FreePieces[6 * 2];
+
+    TArray<APieceBase*> ActivePieces;
+    TArray<FPendingSpawn> PendingSpawns;
+};
@@ -0,0 +1,89 @@
+#include "Bench.h"
+
+#include <chrono>
+#include <cmath>
+
+#include "ChessEngine.h"
+#include "Notation.h"
+#include "Search.h"
+
+
+namespace {
+
+struct BenchPosition {
+    const char* name;
+    const char* notation;
+};
+
+// version 1, see bench_version
+const BenchPosition bench_positions[] = {
+    {"initial", "b/qbk/n1b1n/r5r/ppppppppp/11/5P5/4P1P4/3P1B1P3/2P2B2P2/1PRNQBKNRP1 w 0 1"},
+    {"open centre", "b/qbk/n1b1n/r5r/ppp1p1ppp/5Pp4/3Pp6/4P1P4/5B1P3/2P2B2P2/1PRNQBKNRP1 w 0 3"},
+    {"bishops out", "b/qbk/n1b1n/r5r/pppp1pppp/5p5/3BPP5/6P4/3P3P3/2P2B2P2/1PRNQBKNRP1 b 1 2"},
+    {"middlegame", "1/1bk/1q3/1n4r/2ppp4/5P1p3/4P6/6P4/3P3N3/4QB5/2R3K4 w 0 1"},
+    {"queen vs king", "1/3/5/6k/9/3Q7/11/5K5/11/11/11 w 0 1"},
+    {"rook vs king", "1/3/2k2/7/9/11/7R3/11/4K6/11/11 b 0 1"},
+    {"pawn race", "1/3/2k2/7/3p1p3/5P5/4P1P4/11/5K5/11/11 w 0 1"}
+};
+
+void hash_node_count(uint64& signature, uint64 nodes) {
+    for (int32 i = 0; i < 8; i++) {
+        signature ^= (nodes >> (i * 8)) & 0xFF;
+        signature *= 0x100000001B3ull;
+    }
+}
+
+}
+
+double BenchReport::get_nps() const {
+    return seconds > 0.0 ? nodes / seconds : 0.0;
+}
+
+double BenchReport::get_tt_hit_rate() const {
+    return tt_probes > 0 ? static_cast<double>(tt_hits) / tt_probes : 0.0;
+}
+
+double BenchReport::get_branching_factor() const {
+    if (nodes_per_depth.size() < 2 || nodes_per_depth.front() == 0) {
+        return 0.0;
+    }
+    double growth = static_cast<double>(nodes_per_depth.back()) / nodes_per_depth.front();
+    return std::pow(growth, 1.0 / (nodes_per_depth.size() - 1));
+}
+
+BenchReport run_bench(int32 depth) {
+    BenchReport report;
+    report.version = bench_version;
+    report.depth = depth;
+    report.nodes_per_depth.assign(depth, 0);
+    report.signature = 0xCBF29CE484222325ull;
+
+    for (const auto& position : bench_positions) {
+        Board board;
+        PositionState state;
+        parse_position(board, position.notation, state);
+
+        // one search per position so every position starts with an empty table
+        Search search;
+        BenchPositionReport position_report;
+        position_report.name = position.name;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int32 d = 1; d <= depth; d++) {
+            search.find_best_move(board, state.is_white_to_move, d);
+            const SearchStats& stats = search.get_stats();
+            position_report.nodes += stats.nodes;
+            report.nodes_per_depth[d - 1] += stats.nodes;
+            report.tt_probes += stats.tt_probes;
+            report.tt_hits += stats.tt_hits;
+            hash_node_count(report.signature, stats.nodes);
+        }
+        position_report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        report.nodes += position_report.nodes;
+        report.seconds += position_report.seconds;
+        report.positions.push_back(position_report);
+    }
+
+    return report;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "EngineTypes.h"
+
+
+// Fixed search benchmark. The position set is versioned: any change to
+// it must bump bench_version so signatures from different sets are never
+// compared against each other.
+
+struct BenchPositionReport {
+    std::string name;
+    uint64 nodes = 0;
+    double seconds = 0.0;
+};
+
+struct BenchReport {
+    int32 version = 0;
+    int32 depth = 0;
+    std::vector<BenchPositionReport> positions;
+
+    uint64 nodes = 0;
+    double seconds = 0.0;
+    uint64 tt_probes = 0;
+    uint64 tt_hits = 0;
+    // total nodes searched per iteration, index 0 is depth 1
+    std::vector<uint64> nodes_per_depth;
+    // FNV-1a over the node counts of every position and depth
+    uint64 signature = 0;
+
+    double get_nps() const;
+    double get_tt_hit_rate() const;
+    // effective branching factor, geometric mean of node growth per iteration
+    double get_branching_factor() const;
+};
+
+const int32 bench_version = 1;
+const int32 bench_default_depth = 3;
+
+// searches every bench position with iterative deepening up to depth
+BenchReport run_bench(int32 depth = bench_default_depth);
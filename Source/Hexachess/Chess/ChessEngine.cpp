@@ -1,29 +1,228 @@
-/*
-#include "ChessEngine.h"
-
-void print_moves(Board* b, int32 x, int32 y, Cell::PieceType pt, Cell::PieceColor pc, string piece_name) {
-    Position p = Position{x, y};
-    b->set_piece(p, pt, pc);
-    list<Position> lp = b->get_valid_moves(p);
-    cout << piece_name << " x: " << p.x << ", y: " << p.y << endl;
-    cout << "Valid moves: " << endl;
-    for_each(lp.begin(), lp.end(), [](Position& p) {
-        cout << "x: " << p.x << ", y: " << p.y << endl;
-    });
-}
-
-int32 main() {
-    cout << "Start test" << endl;
-
-    Board* b = new Board();
-
-    print_moves(b, 0, 0, Cell::PieceType::knight, Cell::PieceColor::white, "White Knight");
-    print_moves(b, 2, 2, Cell::PieceType::pawn, Cell::PieceColor::black, "Black Pawn");
-    print_moves(b, 3, 2, Cell::PieceType::pawn, Cell::PieceColor::white, "White Pawn");
-    print_moves(b, 5, 6, Cell::PieceType::pawn, Cell::PieceColor::black, "Black Pawn");
-    print_moves(b, 4, 4, Cell::PieceType::bishop, Cell::PieceColor::white, "White Bishop");
-
-    cout << "End test" << endl;
-    return 0;
-}
-*/
\ No newline at end of file
+#include "ChessEngine.h"
+
+#include <cstring>
+
+#if !HEXACHESS_STANDALONE
+DEFINE_STAT(STAT_HexachessSearch);
+DEFINE_STAT(STAT_HexachessMoveGeneration);
+DEFINE_STAT(STAT_HexachessLegalityCheck);
+DEFINE_STAT(STAT_HexachessEvaluate);
+DEFINE_STAT(STAT_HexachessTTProbe);
+#endif
+
+namespace {
+
+// keys are indexed by the raw cell coordinates, which keeps lookups free of any key -> index mapping
+struct ZobristKeys {
+    uint64 pieces[11][11][2][7];
+    uint64 white_to_move;
+
+    ZobristKeys() {
+        // fixed seed so hashes are stable between runs and builds
+        uint64 seed = 0x48657861636865ull;
+        const auto next = [&seed]() {
+            // splitmix64
+            uint64 z = (seed += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        };
+        for (auto& column : pieces) {
+            for (auto& cell : column) {
+                for (auto& color : cell) {
+                    for (auto& piece : color) {
+                        piece = next();
+                    }
+                }
+            }
+        }
+        white_to_move = next();
+    }
+};
+
+const ZobristKeys zobrist_keys;
+
+const char cell_file_names[] = "abcdefghikl";
+// indexed by Cell::PieceType, only knight to queen can follow a move
+const char promotion_names[] = " pnbrqk";
+
+}
+
+void Board::setup_initial_position() {
+    for (auto& [key, cell] : board_map) {
+        cell->remove_piece();
+    }
+
+    struct PiecePlacement {
+        int32 x, y;
+        Cell::PieceType pt;
+    };
+
+    // white side, black mirrors it vertically on each column
+    const PiecePlacement placements[] = {
+        {2, 0, Cell::PieceType::rook},
+        {8, 0, Cell::PieceType::rook},
+        {3, 0, Cell::PieceType::knight},
+        {7, 0, Cell::PieceType::knight},
+        {4, 0, Cell::PieceType::queen},
+        {6, 0, Cell::PieceType::king},
+        {5, 0, Cell::PieceType::bishop},
+        {5, 1, Cell::PieceType::bishop},
+        {5, 2, Cell::PieceType::bishop}
+    };
+
+    for (const auto& placement : placements) {
+        int32 column_top = median + (placement.x <= median ? placement.x : max - placement.x);
+        board_map[to_position_key(placement.x, placement.y)]->set_piece(placement.pt, Cell::PieceColor::white);
+        board_map[to_position_key(placement.x, column_top - placement.y)]->set_piece(placement.pt, Cell::PieceColor::black);
+    }
+
+    for (int32 key : white_pawn_cell_keys) {
+        board_map[key]->set_piece(Cell::PieceType::pawn, Cell::PieceColor::white);
+    }
+    for (int32 key : black_pawn_cell_keys) {
+        board_map[key]->set_piece(Cell::PieceType::pawn, Cell::PieceColor::black);
+    }
+}
+
+bool Board::setup_pieces(const vector<PiecePlacement>& placements, vector<SetupConflict>& conflicts) {
+    conflicts.clear();
+
+    CellMask occupied;
+    int32 king_counts[3] = {0, 0, 0};
+    for (int32 i = 0; i < static_cast<int32>(placements.size()); i++) {
+        const PiecePlacement& placement = placements[i];
+        if (!is_valid_position(placement.key) || placement.pt == Cell::PieceType::none || placement.pc == Cell::PieceColor::absent) {
+            conflicts.push_back(SetupConflict{i, SetupConflict::invalid_cell});
+            continue;
+        }
+        int32 index = to_cell_index(placement.key);
+        if (occupied.test(index)) {
+            conflicts.push_back(SetupConflict{i, SetupConflict::occupied_cell});
+            continue;
+        }
+        occupied.set(index);
+        if (placement.pt == Cell::PieceType::king) {
+            king_counts[placement.pc]++;
+        }
+    }
+    if (king_counts[Cell::PieceColor::white] != 1 || king_counts[Cell::PieceColor::black] != 1) {
+        conflicts.push_back(SetupConflict{-1, SetupConflict::king_count});
+    }
+    if (!conflicts.empty()) {
+        return false;
+    }
+
+    for (auto& [key, cell] : board_map) {
+        cell->remove_piece();
+    }
+    for (const PiecePlacement& placement : placements) {
+        board_map[placement.key]->set_piece(placement.pt, placement.pc);
+    }
+    return true;
+}
+
+uint64 Board::get_hash(bool is_white_to_move) {
+    return get_hash(board_map, is_white_to_move);
+}
+
+uint64 Board::get_hash(map<int32, Cell*>& in_board, bool is_white_to_move) {
+    uint64 hash = is_white_to_move ? zobrist_keys.white_to_move : 0;
+    for (const auto& [key, cell] : in_board) {
+        if (cell->has_piece()) {
+            int32 color_index = cell->get_piece_color() == Cell::PieceColor::white ? 0 : 1;
+            hash ^= zobrist_keys.pieces[get_x(key)][get_y(key)][color_index][cell->get_piece_type()];
+        } else if (cell->get_en_passant() != Cell::PieceColor::absent) {
+            // the en passant cell is empty, so its slot of the empty piece type is free
+            int32 color_index = cell->get_en_passant() == Cell::PieceColor::white ? 0 : 1;
+            hash ^= zobrist_keys.pieces[get_x(key)][get_y(key)][color_index][Cell::PieceType::none];
+        }
+    }
+    return hash;
+}
+
+string Board::to_cell_name(int32 key) {
+    return string(1, cell_file_names[get_x(key)]) + to_string(get_y(key) + 1);
+}
+
+int32 Board::from_cell_name(const string& name) {
+    if (name.size() < 2 || name.size() > 3) {
+        return -1;
+    }
+    const char* file = strchr(cell_file_names, name[0]);
+    if (file == nullptr || *file == '\0') {
+        return -1;
+    }
+    int32 rank = 0;
+    for (size_t i = 1; i < name.size(); i++) {
+        if (name[i] < '0' || name[i] > '9') {
+            return -1;
+        }
+        rank = rank * 10 + (name[i] - '0');
+    }
+    int32 key = to_position_key(static_cast<int32>(file - cell_file_names), rank - 1);
+    return rank > 0 && is_valid_position(key) ? key : -1;
+}
+
+string Board::to_move_name(const Move& move) {
+    if (!move.is_valid()) {
+        return "0000";
+    }
+    string name = to_cell_name(move.from_key) + to_cell_name(move.to_key);
+    if (move.promotion != Cell::PieceType::none) {
+        name += promotion_names[move.promotion];
+    }
+    return name;
+}
+
+Move Board::from_move_name(const string& name) {
+    // cell names end with a digit, a trailing letter is the promotion
+    string cells = name;
+    Cell::PieceType promotion = Cell::PieceType::none;
+    if (!cells.empty() && (cells.back() < '0' || cells.back() > '9')) {
+        const char* promotion_name = strchr(promotion_names, cells.back());
+        if (promotion_name == nullptr || *promotion_name == '\0' || *promotion_name == ' ' || *promotion_name == 'p' || *promotion_name == 'k') {
+            return Move();
+        }
+        promotion = static_cast<Cell::PieceType>(promotion_name - promotion_names);
+        cells.pop_back();
+    }
+
+    // the target starts at the second file letter
+    for (size_t split = 2; split < cells.size(); split++) {
+        if (cells[split] >= 'a' && cells[split] <= 'z') {
+            int32 from_key = from_cell_name(cells.substr(0, split));
+            int32 to_key = from_cell_name(cells.substr(split));
+            if (from_key != -1 && to_key != -1) {
+                return Move(from_key, to_key, promotion);
+            }
+            break;
+        }
+    }
+    return Move();
+}
+
+uint64 Board::perft(int32 depth, Cell::PieceColor pc) {
+    return perft(board_map, depth, pc);
+}
+
+uint64 Board::perft(map<int32, Cell*>& in_board, int32 depth, Cell::PieceColor pc) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    Cell::PieceColor opposite_color = pc == Cell::PieceColor::white ? Cell::PieceColor::black : Cell::PieceColor::white;
+    vector<Move> moves = get_legal_moves(in_board, pc);
+    if (depth == 1) {
+        return moves.size();
+    }
+
+    uint64 nodes = 0;
+    for (const Move& move : moves) {
+        auto board_copy = copy_board_map(in_board);
+        make_move(board_copy, move);
+        nodes += perft(board_copy, depth - 1, opposite_color);
+        clear_board_map(board_copy);
+    }
+    return nodes;
+}
@@ -1,8 +1,15 @@
+#pragma once
+
 #include <map>
 #include <list>
 #include <algorithm>
+#include <string>
 #include <vector>
 
+#include "EngineStats.h"
+#include "EngineTypes.h"
+#include "HexCoordinates.h"
+
 #if WITH_EDITOR
 #include <CoreMinimal.h>
 DEFINE_LOG_CATEGORY_STATIC(LogChessEngine, Log, All);
@@ -18,6 +25,32 @@ struct Position {
     int32 x, y;
 };
 
+// one bit per board cell, indexed by Board::to_cell_index
+struct CellMask {
+
+    void set(int32 index) {
+        bits[index >> 6] |= uint64(1) << (index & 63);
+    }
+
+    bool test(int32 index) const {
+        return (bits[index >> 6] >> (index & 63)) & 1;
+    }
+
+    bool any() const {
+        return (bits[0] | bits[1]) != 0;
+    }
+
+    bool operator==(const CellMask& other) const {
+        return bits[0] == other.bits[0] && bits[1] == other.bits[1];
+    }
+
+    bool operator!=(const CellMask& other) const {
+        return !(*this == other);
+    }
+
+    uint64 bits[2] = {0, 0};
+};
+
 class Cell {
     public:
     enum PieceType {
@@ -30,7 +63,7 @@ class Cell {
 
     Cell() {}
     Cell(PieceType pt, PieceColor pc): piece(pt), piece_color(pc) {}
-    Cell(Cell& other): piece(other.piece), piece_color(other.piece_color) {}
+    Cell(Cell& other): piece(other.piece), piece_color(other.piece_color), en_passant_color(other.en_passant_color) {}
 
     void set_piece(PieceType pt, PieceColor pc) {
         piece = pt;
@@ -40,6 +73,17 @@ class Cell {
     void remove_piece() {
         piece = PieceType::none;
         piece_color = PieceColor::absent;
+        en_passant_color = PieceColor::absent;
+    }
+
+    // set on the cell a pawn skipped with its double step, for the next move only
+    void set_en_passant(PieceColor pc) {
+        en_passant_color = pc;
+    }
+
+    // color of the pawn that can be taken en passant on this cell, absent when none
+    PieceColor get_en_passant() {
+        return en_passant_color;
     }
 
     bool has_piece() {
@@ -91,6 +135,47 @@ class Cell {
     private:
     PieceType piece = PieceType::none;
     PieceColor piece_color = PieceColor::absent;
+    PieceColor en_passant_color = PieceColor::absent;
+};
+
+struct Move {
+
+    Move() {}
+    Move(int32 from_key, int32 to_key): from_key(from_key), to_key(to_key) {}
+    Move(int32 from_key, int32 to_key, Cell::PieceType promotion): from_key(from_key), to_key(to_key), promotion(promotion) {}
+
+    bool is_valid() const {
+        return from_key != -1 && to_key != -1;
+    }
+
+    bool operator==(const Move& other) const {
+        return from_key == other.from_key && to_key == other.to_key && promotion == other.promotion;
+    }
+
+    bool operator!=(const Move& other) const {
+        return !(*this == other);
+    }
+
+    int32 from_key = -1;
+    int32 to_key = -1;
+    // piece a pawn becomes on the last cell of its column, none for every other move
+    Cell::PieceType promotion = Cell::PieceType::none;
+};
+
+struct PiecePlacement {
+    int32 key;
+    Cell::PieceType pt;
+    Cell::PieceColor pc;
+};
+
+struct SetupConflict {
+    enum Reason {
+        invalid_cell, occupied_cell, king_count
+    };
+
+    // index into the placements, -1 when the conflict is about the whole board
+    int32 placement_index;
+    Reason reason;
 };
 
 class Board {
@@ -106,19 +191,19 @@ class Board {
     };
 
     Board() {
-        for (int32 x = 0; x <= max; x++) {
-            int32 y_max = median + x;
-            if (y_max > max) {
-                y_max = max - y_max % max;
-            }
-            for (int32 y = 0; y <= y_max; y++) {
-                int32 pos = to_position_key(x, y);
-                Cell* cell = new Cell();
-                board_map[pos] = cell;
-            }
+        for (int32 index = 0; index < cell_count; index++) {
+            board_map[from_cell_index(index)] = new Cell();
         }
     }
 
+    // cells are owned by the board, copy positions with copy_board_map instead
+    Board(const Board&) = delete;
+    Board& operator=(const Board&) = delete;
+
+    ~Board() {
+        clear_board_map(board_map);
+    }
+
     bool is_valid_position(int32 x, int32 y) {
         int32 pos = to_position_key(x, y);
         return is_valid_position(pos);
@@ -142,31 +227,10 @@ class Board {
     list<int32> get_valid_moves(map<int32, Cell*>& in_board, int32 key, bool skip_filter = false) {
         Cell* cell = in_board[key];
         list<int32> l = {};
-        switch (cell->get_piece_type()) {
-            case Cell::PieceType::none:
-                break;
-            case Cell::PieceType::pawn:
-                add_pawn_moves(in_board, l, key, cell);
-                break;
-            case Cell::PieceType::bishop:
-                add_bishop_moves(in_board, l, key, cell);
-                break;
-            case Cell::PieceType::knight:
-                add_knight_moves(in_board, l, key, cell);
-                break;
-            case Cell::PieceType::rook:
-                add_rook_moves(in_board, l, key, cell);
-                break;
-            case Cell::PieceType::queen:
-                add_queen_moves(in_board, l, key, cell);
-                break;
-            case Cell::PieceType::king:
-                add_king_moves(in_board, l, key, cell);
-                break;
-        }
+        add_piece_moves(in_board, l, key, cell);
 
         list<int32> filtered_list = {};
-        auto color_pieces = get_piece_keys(cell->get_piece_color());
+        auto color_pieces = get_piece_keys(in_board, cell->get_piece_color());
         int32 king_key = -1;
         for (auto piece_key : color_pieces) {
             if (in_board[piece_key]->get_piece_type() == Cell::PieceType::king) {
@@ -177,8 +241,10 @@ class Board {
         if (skip_filter || king_key == -1) {
             return l;
         }
+
+        HEXENGINE_SCOPE_CYCLE_COUNTER(STAT_HexachessLegalityCheck);
         for (int32 k : l) {
-            auto board_copy = copy_board_map();
+            auto board_copy = copy_board_map(in_board);
             Position start = to_position(key);
             Position goal = to_position(k);
 
@@ -231,11 +297,39 @@ class Board {
         return l;
     }
 
+    static inline int32 to_position_key(int32 x, int32 y) {
+        return (x << 8) + y;
+    }
+
+    static inline int32 to_position_key(Position pos) {
+        return to_position_key(pos.x, pos.y);
+    }
+
     Position to_position(int32 key) {
         Position pos = Position{get_x(key), get_y(key)};
         return pos;
     }
 
+    static const int32 cell_count = HexCoordinates::cell_count;
+
+    // dense 0..90 cell numbering, column by column from the bottom of each column (Chess/HexCoordinates.h)
+    static int32 to_cell_index(int32 key) {
+        return HexCoordinates::to_index(key);
+    }
+
+    static int32 from_cell_index(int32 index) {
+        return HexCoordinates::to_key(index);
+    }
+
+    // Glinski cell names: files a-l without j, ranks counted from 1 ("f5")
+    string to_cell_name(int32 key);
+    // -1 when the name is not a cell of the board
+    int32 from_cell_name(const string& name);
+
+    // long algebraic move text ("f5f6"), an invalid move when it can't be parsed
+    string to_move_name(const Move& move);
+    Move from_move_name(const string& name);
+
     bool are_there_valid_moves(Cell::PieceColor pc) {
         return are_there_valid_moves(board_map, pc);
     }
@@ -245,11 +339,129 @@ class Board {
         return all_moves.size() > 0;
     }
 
-    bool move_piece(Position& start, Position& goal) {
-        return move_piece(board_map, start, goal);
+    // captures and pawn moves can't be undone, positions before them never come back;
+    // promotions and en passant are pawn moves
+    bool is_irreversible_move(const Move& move) {
+        return is_irreversible_move(board_map, move);
     }
 
-    bool move_piece(map<int32, Cell*>& in_board, Position& start, Position& goal) {
+    bool is_irreversible_move(map<int32, Cell*>& in_board, const Move& move) {
+        return in_board[move.to_key]->has_piece() || in_board[move.from_key]->get_piece_type() == Cell::PieceType::pawn;
+    }
+
+    // a pawn reaching the last cell of its column, white on top and black at the bottom
+    static bool is_promotion_move(map<int32, Cell*>& in_board, int32 from_key, int32 to_key) {
+        Cell* cell = in_board[from_key];
+        if (cell->get_piece_type() != Cell::PieceType::pawn) {
+            return false;
+        }
+        return cell->get_piece_color() == Cell::PieceColor::white ? get_y(to_key) == get_column_top(get_x(to_key)) : get_y(to_key) == 0;
+    }
+
+    // a pawn taking on the cell an enemy pawn skipped with its double step on the previous move
+    static bool is_en_passant_move(map<int32, Cell*>& in_board, int32 from_key, int32 to_key) {
+        Cell* cell = in_board[from_key];
+        return cell->get_piece_type() == Cell::PieceType::pawn
+               && in_board[to_key]->get_en_passant() != Cell::PieceColor::absent
+               && in_board[to_key]->get_en_passant() != cell->get_piece_color();
+    }
+
+    // where a double step of a pawn of the color that skips the cell lands, -1 when no double step skips it
+    int32 get_double_step_key(int32 passed_key, Cell::PieceColor pc) const {
+        const vector<int32>& start_keys = pc == Cell::PieceColor::white ? white_pawn_cell_keys : black_pawn_cell_keys;
+        for (int32 start_key : start_keys) {
+            if (passed_key == (pc == Cell::PieceColor::white ? move_vertically_up(start_key) : move_vertically_down(start_key))) {
+                return pc == Cell::PieceColor::white ? move_vertically_up(passed_key) : move_vertically_down(passed_key);
+            }
+        }
+        return -1;
+    }
+
+    // every legal move of the color, each promotion once per piece it can become
+    vector<Move> get_legal_moves(Cell::PieceColor pc) {
+        return get_legal_moves(board_map, pc);
+    }
+
+    vector<Move> get_legal_moves(map<int32, Cell*>& in_board, Cell::PieceColor pc) {
+        vector<Move> moves;
+        for (int32 piece : get_piece_keys(in_board, pc)) {
+            for (int32 target : get_valid_moves(in_board, piece)) {
+                if (!is_promotion_move(in_board, piece, target)) {
+                    moves.push_back(Move(piece, target));
+                    continue;
+                }
+                for (Cell::PieceType promotion : promotion_types) {
+                    moves.push_back(Move(piece, target, promotion));
+                }
+            }
+        }
+        return moves;
+    }
+
+    // a move of the color get_legal_moves would list, a promotion without a piece stands for the queen
+    bool is_legal_move(const Move& move, Cell::PieceColor pc) {
+        return is_legal_move(board_map, move, pc);
+    }
+
+    bool is_legal_move(map<int32, Cell*>& in_board, const Move& move, Cell::PieceColor pc) {
+        if (!move.is_valid() || in_board[move.from_key]->get_piece_color() != pc) {
+            return false;
+        }
+        if (move.promotion != Cell::PieceType::none && !is_promotion_move(in_board, move.from_key, move.to_key)) {
+            return false;
+        }
+        list<int32> targets = get_valid_moves(in_board, move.from_key);
+        return find(targets.begin(), targets.end(), move.to_key) != targets.end();
+    }
+
+    // Two bytes per move: from cell index in bits 0-6, to cell index in
+    // bits 7-13, and the promotion piece in bits 14-15 as an offset from
+    // the knight. Whether a move promotes at all depends on the board, so
+    // unpacking needs it; a pawn move to its last cell is always one. No
+    // move packs to 0, which stands for an invalid move.
+    static uint16 pack_move(const Move& move) {
+        if (!move.is_valid()) {
+            return 0;
+        }
+        uint16 promotion = move.promotion == Cell::PieceType::none ? 0 : static_cast<uint16>(move.promotion - Cell::PieceType::knight);
+        return static_cast<uint16>(to_cell_index(move.from_key) | to_cell_index(move.to_key) << 7 | promotion << 14);
+    }
+
+    Move unpack_move(map<int32, Cell*>& in_board, uint16 packed_move) {
+        const int32 from_index = packed_move & 0x7f;
+        const int32 to_index = packed_move >> 7 & 0x7f;
+        if (from_index >= cell_count || to_index >= cell_count || from_index == to_index) {
+            return Move();
+        }
+        Move move(from_cell_index(from_index), from_cell_index(to_index));
+        if (is_promotion_move(in_board, move.from_key, move.to_key)) {
+            move.promotion = static_cast<Cell::PieceType>(Cell::PieceType::knight + (packed_move >> 14));
+        }
+        return move;
+    }
+
+    Move unpack_move(uint16 packed_move) {
+        return unpack_move(board_map, packed_move);
+    }
+
+    // plays the move, promotions without a piece become queens
+    bool make_move(const Move& move) {
+        return make_move(board_map, move);
+    }
+
+    bool make_move(map<int32, Cell*>& in_board, const Move& move) {
+        Position start = to_position(move.from_key);
+        Position goal = to_position(move.to_key);
+        return move_piece(in_board, start, goal, move.promotion == Cell::PieceType::none ? Cell::PieceType::queen : move.promotion);
+    }
+
+    bool move_piece(Position& start, Position& goal, Cell::PieceType promotion = Cell::PieceType::queen) {
+        return move_piece(board_map, start, goal, promotion);
+    }
+
+    // also takes the pawn passed by en passant, promotes a pawn reaching its
+    // last cell and updates the en passant cells
+    bool move_piece(map<int32, Cell*>& in_board, Position& start, Position& goal, Cell::PieceType promotion = Cell::PieceType::queen) {
         bool is_main_board = &in_board == &board_map;
 
         #if WITH_EDITOR
@@ -258,11 +470,24 @@ class Board {
         #endif
 
         int32 sp = to_position_key(start);
-        if (is_valid_position(in_board, sp) && is_valid_position(in_board, goal)) {
+        int32 gp = to_position_key(goal);
+        if (is_valid_position(in_board, sp) && is_valid_position(in_board, gp)) {
             Cell::PieceType pt = in_board[sp]->get_piece_type();
             Cell::PieceColor pc = in_board[sp]->get_piece_color();
+            bool is_white = pc == Cell::PieceColor::white;
+            if (is_en_passant_move(in_board, sp, gp)) {
+                // the passed pawn stands one cell further from the mover
+                in_board[is_white ? move_vertically_down(gp) : move_vertically_up(gp)]->remove_piece();
+            }
+            if (is_promotion_move(in_board, sp, gp)) {
+                pt = promotion;
+            }
+            clear_en_passant(in_board);
             in_board[sp]->remove_piece();
             set_piece(in_board, goal, pt, pc);
+            if (pt == Cell::PieceType::pawn && get_x(sp) == get_x(gp) && abs(get_y(gp) - get_y(sp)) == 2) {
+                in_board[is_white ? move_vertically_up(sp) : move_vertically_down(sp)]->set_en_passant(pc);
+            }
         }
         return true;
     }
@@ -295,6 +520,8 @@ class Board {
 
     int32 evaluate(map<int32, Cell*>& in_board)
     {
+        HEXENGINE_SCOPE_CYCLE_COUNTER(STAT_HexachessEvaluate);
+
         // set up some scoring for figures
         int32 score = 0;
 
@@ -360,6 +587,30 @@ class Board {
         in_board.clear();  // Clears the map
     }
 
+    // copies the pieces of another board without reallocating any cell
+    void copy_pieces_from(Board& other) {
+        for (auto& [key, cell] : board_map) {
+            Cell* other_cell = other.board_map[key];
+            cell->set_piece(other_cell->get_piece_type(), other_cell->get_piece_color());
+            cell->set_en_passant(other_cell->get_en_passant());
+        }
+    }
+
+    // removes every piece and puts the standard Glinski setup on the main board
+    void setup_initial_position();
+
+    // replaces every piece of the main board in one pass, each color needs exactly one king;
+    // returns false and leaves the board untouched when there are conflicts
+    bool setup_pieces(const vector<PiecePlacement>& placements, vector<SetupConflict>& conflicts);
+
+    // zobrist key of the position, side to move included
+    uint64 get_hash(bool is_white_to_move);
+    uint64 get_hash(map<int32, Cell*>& in_board, bool is_white_to_move);
+
+    // counts the leaf nodes of the legal move tree, used to validate move generation
+    uint64 perft(int32 depth, Cell::PieceColor pc);
+    uint64 perft(map<int32, Cell*>& in_board, int32 depth, Cell::PieceColor pc);
+
     map<int32, Cell*> board_map;
 
 
@@ -371,15 +622,22 @@ private:
     static const int32 median = 5;
     static const int32 max = 10;
     static const int32 step_x = 1 << 8;
+    static constexpr Cell::PieceType promotion_types[4] = {Cell::PieceType::queen, Cell::PieceType::rook, Cell::PieceType::bishop, Cell::PieceType::knight};
     const vector<int32> white_pawn_cell_keys = {256, 513, 770, 1027, 1284, 1539, 1794, 2049, 2304};
     const vector<int32> black_pawn_cell_keys = {262, 518, 774, 1030, 1286, 1542, 1798, 2054, 2310};
 
-    inline int32 to_position_key(int32 x, int32 y) {
-        return (x << 8) + y;
+    static int32 get_column_top(int32 x) {
+        return HexCoordinates::get_column_height(x) - 1;
     }
 
-    inline int32 to_position_key(Position pos) {
-        return to_position_key(pos.x, pos.y);
+    // only the cells right in front of the initial pawn cells can be passed
+    void clear_en_passant(map<int32, Cell*>& in_board) {
+        for (int32 key : white_pawn_cell_keys) {
+            in_board[move_vertically_up(key)]->set_en_passant(Cell::PieceColor::absent);
+        }
+        for (int32 key : black_pawn_cell_keys) {
+            in_board[move_vertically_down(key)]->set_en_passant(Cell::PieceColor::absent);
+        }
     }
 
     inline bool is_valid_position(int32 key) {
@@ -398,6 +656,33 @@ private:
         return is_valid_position(in_board, to_position_key(pos));
     }
 
+    void add_piece_moves(map<int32, Cell*>& in_board, list<int32>& l, int32 key, Cell* cell) {
+        HEXENGINE_SCOPE_CYCLE_COUNTER(STAT_HexachessMoveGeneration);
+
+        switch (cell->get_piece_type()) {
+            case Cell::PieceType::none:
+                break;
+            case Cell::PieceType::pawn:
+                add_pawn_moves(in_board, l, key, cell);
+                break;
+            case Cell::PieceType::bishop:
+                add_bishop_moves(in_board, l, key, cell);
+                break;
+            case Cell::PieceType::knight:
+                add_knight_moves(in_board, l, key, cell);
+                break;
+            case Cell::PieceType::rook:
+                add_rook_moves(in_board, l, key, cell);
+                break;
+            case Cell::PieceType::queen:
+                add_queen_moves(in_board, l, key, cell);
+                break;
+            case Cell::PieceType::king:
+                add_king_moves(in_board, l, key, cell);
+                break;
+        }
+    }
+
     void add_pawn_moves(map<int32, Cell*>& in_board, list<int32>& l, int32 key, Cell* cell) {
         TMoveFn fn_move, fn_take_1, fn_take_2;
         switch (cell->get_piece_color()) {
@@ -428,7 +713,12 @@ private:
     }
 
     void add_pawn_take_if_valid(map<int32, Cell*>& in_board, list<int32>& l, int32 key, Cell* cell) {
-        if (is_valid_position(in_board, key) && in_board[key]->has_piece_of_opposite_color(cell)) {
+        if (!is_valid_position(in_board, key)) {
+            return;
+        }
+        Cell* target = in_board[key];
+        Cell::PieceColor en_passant = target->get_en_passant();
+        if (target->has_piece_of_opposite_color(cell) || (en_passant != Cell::PieceColor::absent && en_passant != cell->get_piece_color())) {
             l.push_front(key);
         }
     }
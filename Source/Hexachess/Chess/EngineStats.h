@@ -0,0 +1,29 @@
+#pragma once
+
+#include "EngineTypes.h"
+
+// Cycle counters (stat Hexachess) and Unreal Insights scopes for the
+// engine hot paths. They compile to nothing in the standalone build.
+
+#if HEXACHESS_STANDALONE
+
+#define HEXENGINE_SCOPE_CYCLE_COUNTER(Stat)
+
+#else
+
+#include <Stats/Stats.h>
+#include <ProfilingDebugging/CpuProfilerTrace.h>
+
+DECLARE_STATS_GROUP(TEXT("Hexachess"), STATGROUP_Hexachess, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Search"), STAT_HexachessSearch, STATGROUP_Hexachess, HEXACHESS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Move generation"), STAT_HexachessMoveGeneration, STATGROUP_Hexachess, HEXACHESS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Legality check"), STAT_HexachessLegalityCheck, STATGROUP_Hexachess, HEXACHESS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Evaluate"), STAT_HexachessEvaluate, STATGROUP_Hexachess, HEXACHESS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TT probe"), STAT_HexachessTTProbe, STATGROUP_Hexachess, HEXACHESS_API);
+
+#define HEXENGINE_SCOPE_CYCLE_COUNTER(Stat) \
+    SCOPE_CYCLE_COUNTER(Stat); \
+    TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+
+#endif
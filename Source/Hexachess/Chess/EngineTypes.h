@@ -0,0 +1,25 @@
+#pragma once
+
+// The chess engine is shared between the Hexachess game module and the
+// standalone CMake build (Tools/HexEngine). Inside Unreal the engine types
+// come from CoreMinimal; the standalone build defines HEXACHESS_STANDALONE
+// and gets the same names from <cstdint>.
+
+#if HEXACHESS_STANDALONE
+
+#include <cstdint>
+
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef int64_t int64;
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+
+#else
+
+#include <CoreMinimal.h>
+
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+
+#include "EngineTypes.h"
+
+using namespace std;
+
+
+// Position hashes (Board::get_hash) of one game, oldest first, with the
+// halfmove clock for the fifty-move rule. The repetition count of the
+// current position is worked out once per move, so asking for it is free.
+class GameHistory {
+    public:
+
+    static const int32 fifty_move_plies = 100;
+
+    void reset(uint64 hash, int32 in_halfmove_clock = 0) {
+        hashes.assign(1, hash);
+        halfmove_clock = in_halfmove_clock;
+        repetition_count = 1;
+    }
+
+    // hash of the position after the move, see Board::is_irreversible_move
+    void push(uint64 hash, bool is_irreversible) {
+        hashes.push_back(hash);
+        halfmove_clock = is_irreversible ? 0 : halfmove_clock + 1;
+        count_repetitions();
+    }
+
+    // picks a saved game up again, the hashes since the last irreversible move are enough
+    void restore(const vector<uint64>& in_hashes, int32 in_halfmove_clock) {
+        hashes = in_hashes;
+        halfmove_clock = in_halfmove_clock;
+        count_repetitions();
+    }
+
+    bool is_empty() const {
+        return hashes.empty();
+    }
+
+    // occurrences of the current position, itself included
+    int32 get_repetition_count() const {
+        return repetition_count;
+    }
+
+    bool is_threefold_repetition() const {
+        return repetition_count >= 3;
+    }
+
+    int32 get_halfmove_clock() const {
+        return halfmove_clock;
+    }
+
+    bool is_fifty_move_draw() const {
+        return halfmove_clock >= fifty_move_plies;
+    }
+
+    const vector<uint64>& get_hashes() const {
+        return hashes;
+    }
+
+    private:
+
+    void count_repetitions() {
+        // only positions since the last irreversible move with the same side to move can match
+        repetition_count = hashes.empty() ? 0 : 1;
+        const int32 last = static_cast<int32>(hashes.size()) - 1;
+        for (int32 i = last - 2; i >= 0 && i >= last - halfmove_clock; i -= 2) {
+            if (hashes[i] == hashes[last]) {
+                repetition_count++;
+            }
+        }
+    }
+
+    vector<uint64> hashes;
+    int32 halfmove_clock = 0;
+    int32 repetition_count = 0;
+};
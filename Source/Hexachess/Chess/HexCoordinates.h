@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cmath>
+
+#include "EngineTypes.h"
+
+
+// Every coordinate system of the Glinski board and the conversions between
+// them, precomputed at compile time:
+//
+//   index   dense 0..90, column by column from the bottom of each column
+//   key     (x << 8) + y as used by Board, x is the file (0..10) and y the
+//           cell within the file counted from the bottom
+//   axial   (q, r) with q = x - 5, the center cell f6 at (0, 0); r grows up
+//           the file and the third cube coordinate is s = -q - r
+//   world   flat-topped hexes around the center cell in units of the cell
+//           radius, x to the right along the files and y up
+//
+// Steps follow the 12 piece directions: the 6 orthogonal (rook) steps first,
+// then the 6 diagonal (bishop) steps. Conversions return -1 for anything
+// outside the board.
+
+struct AxialCoord {
+    int32 q = 0;
+    int32 r = 0;
+
+    constexpr int32 s() const {
+        return -q - r;
+    }
+};
+
+struct WorldCoord {
+    float x = 0.0f;
+    float y = 0.0f;
+};
+
+struct HexCoordinateTables {
+    static const int32 cell_count = 91;
+    static const int32 radius = 5;
+    static const int32 side = 2 * radius + 1;
+    static const int32 direction_count = 12;
+
+    int16 index_keys[cell_count] = {};
+    // [x][y] and [q + radius][r + radius]
+    int8 key_indices[side][side] = {};
+    int8 axial_indices[side][side] = {};
+    AxialCoord axial[cell_count] = {};
+    int8 steps[direction_count][cell_count] = {};
+    WorldCoord world[cell_count] = {};
+};
+
+constexpr HexCoordinateTables make_hex_coordinate_tables() {
+    const int32 radius = HexCoordinateTables::radius;
+    const int32 side = HexCoordinateTables::side;
+    const int32 direction_offsets[HexCoordinateTables::direction_count][2] = {
+        {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, -1}, {-1, 1},
+        {1, 1}, {-1, -1}, {2, -1}, {-2, 1}, {1, -2}, {-1, 2}
+    };
+    const double sqrt3 = 1.7320508075688772;
+
+    HexCoordinateTables tables;
+    for (int32 x = 0; x < side; x++) {
+        for (int32 y = 0; y < side; y++) {
+            tables.key_indices[x][y] = -1;
+            tables.axial_indices[x][y] = -1;
+        }
+    }
+
+    int32 index = 0;
+    for (int32 x = 0; x < side; x++) {
+        const int32 q = x - radius;
+        const int32 height = side - (q < 0 ? -q : q);
+        for (int32 y = 0; y < height; y++, index++) {
+            const int32 r = y - radius - (q < 0 ? q : 0);
+            tables.index_keys[index] = static_cast<int16>((x << 8) + y);
+            tables.key_indices[x][y] = static_cast<int8>(index);
+            tables.axial_indices[q + radius][r + radius] = static_cast<int8>(index);
+            tables.axial[index] = AxialCoord{q, r};
+            tables.world[index] = WorldCoord{static_cast<float>(1.5 * q), static_cast<float>(sqrt3 * (r + 0.5 * q))};
+        }
+    }
+
+    for (index = 0; index < HexCoordinateTables::cell_count; index++) {
+        for (int32 direction = 0; direction < HexCoordinateTables::direction_count; direction++) {
+            const int32 q = tables.axial[index].q + direction_offsets[direction][0] + radius;
+            const int32 r = tables.axial[index].r + direction_offsets[direction][1] + radius;
+            const bool is_inside = q >= 0 && q < side && r >= 0 && r < side;
+            tables.steps[direction][index] = is_inside ? tables.axial_indices[q][r] : -1;
+        }
+    }
+    return tables;
+}
+
+inline constexpr HexCoordinateTables hex_coordinate_tables = make_hex_coordinate_tables();
+
+class HexCoordinates {
+    public:
+
+    static const int32 cell_count = HexCoordinateTables::cell_count;
+    static const int32 radius = HexCoordinateTables::radius;
+    static const int32 direction_count = HexCoordinateTables::direction_count;
+    // the longest line of cells a slider can cross
+    static const int32 max_ray_length = 2 * radius;
+
+    static constexpr int32 get_column_height(int32 x) {
+        return HexCoordinateTables::side - (x < radius ? radius - x : x - radius);
+    }
+
+    static constexpr int32 to_key(int32 index) {
+        return is_index(index) ? hex_coordinate_tables.index_keys[index] : -1;
+    }
+
+    static constexpr int32 to_index(int32 key) {
+        const int32 x = key >> 8;
+        const int32 y = key & 0xff;
+        return key >= 0 && x < HexCoordinateTables::side && y < HexCoordinateTables::side ? hex_coordinate_tables.key_indices[x][y] : -1;
+    }
+
+    static constexpr AxialCoord to_axial(int32 index) {
+        return hex_coordinate_tables.axial[index];
+    }
+
+    static constexpr int32 from_axial(int32 q, int32 r) {
+        q += radius;
+        r += radius;
+        return q >= 0 && q < HexCoordinateTables::side && r >= 0 && r < HexCoordinateTables::side ? hex_coordinate_tables.axial_indices[q][r] : -1;
+    }
+
+    static constexpr int32 from_axial(const AxialCoord& axial) {
+        return from_axial(axial.q, axial.r);
+    }
+
+    static constexpr WorldCoord to_world(int32 index) {
+        return hex_coordinate_tables.world[index];
+    }
+
+    // the cell whose hexagon contains the point
+    static int32 from_world(float x, float y) {
+        const double q = x / 1.5;
+        const double r = y / 1.7320508075688772 - q * 0.5;
+        return from_axial(round_axial(q, r));
+    }
+
+    // number of king steps between two cells
+    static constexpr int32 get_distance(int32 from_index, int32 to_index) {
+        const AxialCoord from = to_axial(from_index);
+        const AxialCoord to = to_axial(to_index);
+        const int32 dq = from.q - to.q;
+        const int32 dr = from.r - to.r;
+        const int32 ds = from.s() - to.s();
+        return ((dq < 0 ? -dq : dq) + (dr < 0 ? -dr : dr) + (ds < 0 ? -ds : ds)) / 2;
+    }
+
+    // the neighbouring cell in a direction, -1 past the edge
+    static constexpr int32 step(int32 index, int32 direction) {
+        return hex_coordinate_tables.steps[direction][index];
+    }
+
+    // cells from the one next to index up to the edge, returns how many
+    static int32 get_ray(int32 index, int32 direction, int32 (&cells)[max_ray_length]) {
+        int32 count = 0;
+        for (int32 cell = step(index, direction); cell != -1; cell = step(cell, direction)) {
+            cells[count++] = cell;
+        }
+        return count;
+    }
+
+    // rotation about the center cell by 60 degrees times the count
+    static constexpr AxialCoord rotate(const AxialCoord& axial, int32 count) {
+        int32 cube[3] = {axial.q, axial.r, axial.s()};
+        for (int32 rotation = 0; rotation < count % 6; rotation++) {
+            const int32 q = -cube[1];
+            const int32 r = -cube[2];
+            const int32 s = -cube[0];
+            cube[0] = q;
+            cube[1] = r;
+            cube[2] = s;
+        }
+        return AxialCoord{cube[0], cube[1]};
+    }
+
+    // mirror image across the line through the center where r equals s, which swaps r and s
+    static constexpr AxialCoord mirror(const AxialCoord& axial) {
+        return AxialCoord{axial.q, axial.s()};
+    }
+
+    private:
+
+    static constexpr bool is_index(int32 index) {
+        return index >= 0 && index < cell_count;
+    }
+
+    static AxialCoord round_axial(double q, double r) {
+        const double s = -q - r;
+        int32 rounded_q = static_cast<int32>(std::lround(q));
+        int32 rounded_r = static_cast<int32>(std::lround(r));
+        const int32 rounded_s = static_cast<int32>(std::lround(s));
+        // the coordinate that moved most is the one to fix
+        const double dq = std::abs(rounded_q - q);
+        const double dr = std::abs(rounded_r - r);
+        const double ds = std::abs(rounded_s - s);
+        if (dq > dr && dq > ds) {
+            rounded_q = -rounded_r - rounded_s;
+        } else if (dr > ds) {
+            rounded_r = -rounded_q - rounded_s;
+        }
+        return AxialCoord{rounded_q, rounded_r};
+    }
+};
@@ -0,0 +1,97 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#if !HEXACHESS_STANDALONE
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+#include <windows.h>
+#if !HEXACHESS_STANDALONE
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void set_error(string* error, const string& message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+}
+
+}
+
+bool MappedFile::open(const string& path, string* error) {
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        set_error(error, "can't open " + path);
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        set_error(error, "can't read " + path);
+        return false;
+    }
+    HANDLE file_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = file_mapping != nullptr ? MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr) {
+        if (file_mapping != nullptr) {
+            CloseHandle(file_mapping);
+        }
+        CloseHandle(file);
+        set_error(error, "can't map " + path);
+        return false;
+    }
+    file_handle = file;
+    mapping_handle = file_mapping;
+    data = view;
+    size = static_cast<size_t>(file_size.QuadPart);
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        set_error(error, "can't open " + path);
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0) {
+        ::close(file);
+        set_error(error, "can't read " + path);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping stays valid after the descriptor is closed
+    ::close(file);
+    if (view == MAP_FAILED) {
+        set_error(error, "can't map " + path);
+        return false;
+    }
+    data = view;
+    size = static_cast<size_t>(file_stat.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+    if (data == nullptr) {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(data);
+    CloseHandle(static_cast<HANDLE>(mapping_handle));
+    CloseHandle(static_cast<HANDLE>(file_handle));
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    munmap(data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+
+#include "EngineTypes.h"
+
+using namespace std;
+
+
+// Read-only memory mapping of a whole file, used for the opening book and
+// the endgame tablebases. Pages are loaded on first access.
+class MappedFile {
+    public:
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        close();
+    }
+
+    // the previous file, if any, is closed first; empty files can't be mapped
+    bool open(const string& path, string* error = nullptr);
+    void close();
+
+    bool is_open() const {
+        return data != nullptr;
+    }
+
+    const uint8* get_data() const {
+        return static_cast<const uint8*>(data);
+    }
+
+    size_t get_size() const {
+        return size;
+    }
+
+    private:
+
+    void* data = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+};
@@ -2,115 +2,230 @@
 
 #include "Actors/ChessGod.h"
 #include "Chess/ChessEngine.h"
+#include "Chess/GameHistory.h"
+#include "Chess/OpeningBook.h"
+#include "Chess/PieceTypeConversion.h"
+#include "Chess/Search.h"
+#include "Chess/SearchScheduler.h"
+#include "Chess/Tablebase.h"
 
 
+namespace
+{
+    FAISearchStats ToAISearchStats(const SearchStats& EngineStats, double Seconds)
+    {
+        FAISearchStats Stats;
+        Stats.Nodes = EngineStats.nodes;
+        Stats.Cutoffs = EngineStats.cutoffs;
+        Stats.TTHits = EngineStats.tt_hits;
+        Stats.TablebaseHits = EngineStats.tb_hits;
+        Stats.DepthReached = EngineStats.depth_reached;
+        Stats.Seconds = Seconds;
+        return Stats;
+    }
+}
+
 void UMinimaxAIComponent::BeginPlay()
 {
     Super::BeginPlay();
 
     ChessGod = Cast<AChessGod>(GetOwner());
+    PonderBoard = new Board();
+
+    AIBook = new OpeningBook();
+    FString BookPath = FPaths::Combine(FPaths::ProjectContentDir(), OpeningBookFile);
+    string Error;
+    if (!AIBook->open(TCHAR_TO_UTF8(*BookPath), &Error))
+    {
+        UE_LOG(LogTemp, Log, TEXT("No opening book: %s"), UTF8_TO_TCHAR(Error.c_str()));
+    }
+
+    AITablebase = new Tablebase();
+    FString TablebasePath = FPaths::Combine(FPaths::ProjectContentDir(), TablebaseDirectory);
+    int32 TableCount = AITablebase->open_directory(TCHAR_TO_UTF8(*TablebasePath));
+    UE_LOG(LogTemp, Log, TEXT("Opened %d endgame tablebases from %s"), TableCount, *TablebasePath);
+
+    SearchScheduler::MatchSettings Settings;
+    Settings.time_budget_ms = SearchTimeBudgetMs;
+    Settings.tablebase = AITablebase;
+    MatchId = SearchScheduler::get_shared().add_match(Settings);
 }
 
-void UMinimaxAIComponent::StartCalculatingMove(Board* ActiveBoard, bool IsWhiteAI, int32 Depth)
+void UMinimaxAIComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    const auto CompleteCallback = [this](TArray<FIntPoint>& Result)
+    // waits for the running search, which uses the boards and tables below
+    SearchScheduler::get_shared().remove_match(MatchId);
+    MatchId = 0;
+    bPonderPending = false;
+
+    delete PonderBoard;
+    PonderBoard = nullptr;
+    delete AIBook;
+    AIBook = nullptr;
+    delete AITablebase;
+    AITablebase = nullptr;
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void UMinimaxAIComponent::StartCalculatingMove(Board* ActiveBoard, const GameHistory& History, bool IsWhiteAI, int32 Depth)
+{
+    // Runs on the game thread, ExpectedLine is our move and the reply we expect
+    // to it when the search found one. Pondering starts here rather than in the
+    // job so the ponder state is only ever touched by the game thread.
+    const auto CompleteCallback = [this, IsWhiteAI, Depth, Generation = SearchGeneration](TArray<FIntPoint>& Result, Cell::PieceType Promotion, const FAISearchStats& Stats, const vector<Move>& ExpectedLine, const GameHistory& SearchedHistory)
     {
-        AsyncTask(ENamedThreads::GameThread, [this, Result]
+        AsyncTask(ENamedThreads::GameThread, [WeakThis = TWeakObjectPtr<UMinimaxAIComponent>(this), Result, Promotion, Stats, ExpectedLine, SearchedHistory, IsWhiteAI, Depth, Generation]
         {
-            if (ChessGod.IsValid())
+            UMinimaxAIComponent* This = WeakThis.Get();
+            // ended play or started a new game while the search ran
+            if (This == nullptr || This->MatchId == 0 || This->SearchGeneration != Generation)
             {
-                ChessGod->OnAIFinishedCalculatingMove.Broadcast(Result[0], Result[1]);
+                return;
+            }
+            if (This->bPonder && ExpectedLine.size() == 2)
+            {
+                This->StartPondering(ExpectedLine[0], ExpectedLine[1], SearchedHistory, IsWhiteAI, Depth);
+            }
+            if (This->ChessGod.IsValid())
+            {
+                This->ChessGod->LastAIPromotion = ToPromotionPieceType(Promotion);
+                This->ChessGod->OnAISearchFinished.Broadcast(Stats);
+                This->ChessGod->OnAIFinishedCalculatingMove.Broadcast(Result[0], Result[1]);
             }
         });
     };
 
-    AsyncTask(ENamedThreads::AnyThread, [this, ActiveBoard, IsWhiteAI, CompleteCallback, Depth]
+    if (bUseOpeningBook && AIBook->is_open())
+    {
+        Move OpeningMove = AIBook->pick_move(*ActiveBoard, IsWhiteAI, static_cast<uint32>(FMath::RandRange(0, MAX_int32)));
+        if (OpeningMove.is_valid())
+        {
+            StopPondering();
+
+            Position FromPosition = ActiveBoard->to_position(OpeningMove.from_key);
+            Position ToPosition = ActiveBoard->to_position(OpeningMove.to_key);
+
+            TArray<FIntPoint> Result;
+            Result.Add(FIntPoint{FromPosition.x, FromPosition.y});
+            Result.Add(FIntPoint{ToPosition.x, ToPosition.y});
+            CompleteCallback(Result, OpeningMove.promotion, FAISearchStats(), vector<Move>(), History);
+            return;
+        }
+    }
+
+    // A ponder hit keeps the running search, anything else aborts it. The
+    // match runs its jobs in order, so the job below starts once the ponder
+    // search is done either way.
+    SearchScheduler& Scheduler = SearchScheduler::get_shared();
+    const bool bWasPondering = bPonderPending;
+    bool bPonderHit = false;
+    if (bWasPondering)
+    {
+        bPonderHit = PonderDepth == Depth && bPonderIsWhiteAI == IsWhiteAI && ActiveBoard->get_hash(IsWhiteAI) == PonderHash;
+        if (!bPonderHit)
+        {
+            Scheduler.stop_match(MatchId);
+        }
+        bPonderPending = false;
+    }
+
+    // pondering continues from the position searched here
+    PonderBoard->copy_pieces_from(*ActiveBoard);
+
+    const double StartTime = FPlatformTime::Seconds();
+    const bool bFindExpectedLine = bPonder;
+    Scheduler.submit(MatchId, ActiveBoard, [this, SearchHistory = History, IsWhiteAI, CompleteCallback, Depth, bPonderHit, bWasPondering, bFindExpectedLine, StartTime](Search& AISearch, Board& SearchBoard)
     {
         TArray<FIntPoint> Result;
 
-        map<int32, Cell*> board = ActiveBoard->board_map;
-        MoveResult ai_result = MiniMax(ActiveBoard, board, Depth, IsWhiteAI, -9000.f, 9000.f);
+        // written by the ponder job that ran before this one
+        int32 FromKey = PonderFromKey;
+        int32 ToKey = PonderToKey;
+        Cell::PieceType Promotion = static_cast<Cell::PieceType>(PonderPromotion);
+        FAISearchStats Stats = PonderStats;
+        if (!bPonderHit)
+        {
+            // the aborted ponder search already aged the tables for this move
+            if (!bWasPondering)
+            {
+                AISearch.age();
+            }
+            AISearch.set_game_history(SearchHistory);
+            SearchLimits Limits;
+            Limits.depth = Depth;
+            SearchResult AIResult = AISearch.think(SearchBoard, IsWhiteAI, Limits);
+            FromKey = AIResult.from_key;
+            ToKey = AIResult.to_key;
+            Promotion = AIResult.promotion;
+            Stats = ToAISearchStats(AISearch.get_stats(), FPlatformTime::Seconds() - StartTime);
+        }
 
-        Position FromPosition = ActiveBoard->to_position(ai_result.FromKey);
-        Position ToPosition = ActiveBoard->to_position(ai_result.ToKey);
+        vector<Move> ExpectedLine;
+        if (bFindExpectedLine)
+        {
+            ExpectedLine = AISearch.get_pv(SearchBoard, IsWhiteAI, 2);
+        }
+
+        Position FromPosition = SearchBoard.to_position(FromKey);
+        Position ToPosition = SearchBoard.to_position(ToKey);
 
         Result.Add(FIntPoint{FromPosition.x, FromPosition.y});
         Result.Add(FIntPoint{ToPosition.x, ToPosition.y});
 
-        CompleteCallback(Result);
+        CompleteCallback(Result, Promotion, Stats, ExpectedLine, SearchHistory);
     });
 }
 
-MoveResult UMinimaxAIComponent::MiniMax(Board* ActiveBoard, map<int32, Cell*>& in_board_map, int32 Depth, bool IsWhitePlayer, int32 Alpha, int32 Beta)
+void UMinimaxAIComponent::ResetContext()
 {
-    if (Depth == 0)
+    StopPondering();
+    // drops the move of a search still running for the previous game
+    SearchGeneration++;
+    SearchScheduler::get_shared().stop_match(MatchId);
+    // runs after the stopped search returns, the match runs one job at a time
+    SearchScheduler::get_shared().submit(MatchId, nullptr, [](Search& AISearch, Board&)
     {
-        return MoveResult(0, 0, ActiveBoard->evaluate(in_board_map));
-    }
+        AISearch.clear();
+    });
+}
 
-    MoveResult Result;
-    if (IsWhitePlayer)
+void UMinimaxAIComponent::StartPondering(const Move& OurMove, const Move& ExpectedReply, const GameHistory& SearchedHistory, bool IsWhiteAI, int32 Depth)
+{
+    GameHistory PonderHistory = SearchedHistory;
+    bool bIsWhiteToMove = IsWhiteAI;
+    for (const Move& ExpectedMove : {OurMove, ExpectedReply})
     {
-        int32 MaxEval = -9000;
-        list<int32> PieceKeys = ActiveBoard->get_piece_keys(in_board_map, Cell::PieceColor::white);
-        for (int32 piece : PieceKeys) {
-            list<int32> MoveKeys = ActiveBoard->get_valid_moves(in_board_map, piece);
-            for (int32 move : MoveKeys) {
-                auto board_copy = ActiveBoard->copy_board_map(in_board_map);
-                Position start = ActiveBoard->to_position(piece);
-                Position goal = ActiveBoard->to_position(move);
-                ActiveBoard->move_piece(board_copy, start, goal);
-                MoveResult child_result = MiniMax(ActiveBoard, board_copy, Depth - 1, false, Alpha, Beta);
-
-                ActiveBoard->clear_board_map(board_copy);
-                if (child_result.Score > MaxEval)
-                {
-                    Result.FromKey = piece;
-                    Result.ToKey = move;
-                }
-                MaxEval = FMath::Max(MaxEval, child_result.Score);
-
-                // pruning
-                Alpha = FMath::Max(Alpha, child_result.Score);
-                if (Beta <= Alpha)
-                {
-                    break;
-                }
-            }
-        }
-        Result.Score = MaxEval;
+        bool bIsIrreversible = PonderBoard->is_irreversible_move(ExpectedMove);
+        PonderBoard->make_move(ExpectedMove);
+        bIsWhiteToMove = !bIsWhiteToMove;
+        PonderHistory.push(PonderBoard->get_hash(bIsWhiteToMove), bIsIrreversible);
     }
-    else
+
+    PonderHash = PonderBoard->get_hash(IsWhiteAI);
+    PonderDepth = Depth;
+    bPonderIsWhiteAI = IsWhiteAI;
+
+    bPonderPending = SearchScheduler::get_shared().submit(MatchId, PonderBoard, [this, PonderHistory, IsWhiteAI, Depth](Search& PonderSearch, Board& PonderSearchBoard)
     {
-        int32 MinEval = 9000;
-        list<int32> PieceKeys = ActiveBoard->get_piece_keys(in_board_map, Cell::PieceColor::black);
-        for (int32 piece : PieceKeys) {
-            list<int32> MoveKeys = ActiveBoard->get_valid_moves(in_board_map, piece);
-            for (int32 move : MoveKeys) {
-                auto board_copy = ActiveBoard->copy_board_map(in_board_map);
-                Position start = ActiveBoard->to_position(piece);
-                Position goal = ActiveBoard->to_position(move);
-                ActiveBoard->move_piece(board_copy, start, goal);
-                MoveResult child_result = MiniMax(ActiveBoard, board_copy, Depth - 1, true, Alpha, Beta);
-
-                ActiveBoard->clear_board_map(board_copy);
-                if (child_result.Score < MinEval)
-                {
-                    Result.FromKey = piece;
-                    Result.ToKey = move;
-                }
-                MinEval = FMath::Min(MinEval, child_result.Score);
-
-                // pruning
-                Beta = FMath::Min(Beta, child_result.Score);
-                if (Beta <= Alpha)
-                {
-                    break;
-                }
-            }
-        }
-        Result.Score = MinEval;
-    }
+        const double StartTime = FPlatformTime::Seconds();
+        PonderSearch.age();
+        PonderSearch.set_game_history(PonderHistory);
+        SearchLimits Limits;
+        Limits.depth = Depth;
+        SearchResult PonderResult = PonderSearch.think(PonderSearchBoard, IsWhiteAI, Limits);
+        PonderFromKey = PonderResult.from_key;
+        PonderToKey = PonderResult.to_key;
+        PonderPromotion = PonderResult.promotion;
+        PonderStats = ToAISearchStats(PonderSearch.get_stats(), FPlatformTime::Seconds() - StartTime);
+    });
+}
 
-    return Result;
+void UMinimaxAIComponent::StopPondering()
+{
+    if (bPonderPending)
+    {
+        SearchScheduler::get_shared().stop_match(MatchId);
+        bPonderPending = false;
+    }
 }
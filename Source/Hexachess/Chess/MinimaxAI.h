@@ -1,35 +1,22 @@
 #pragma once
 
-#include <map>
-
 #include "Async/Async.h"
 #include "CoreMinimal.h"
 
+#include "Types/AISearchStats.h"
 #include "Types/AIType.h"
 #include "Types/PieceInfo.h"
 
 #include "MinimaxAI.generated.h"
 
-using namespace std;
-
 class AChessGod;
 class Board;
-class Cell;
-
+class GameHistory;
+class OpeningBook;
+class Search;
+class Tablebase;
+struct Move;
 
-struct MoveResult
-{
-	MoveResult() = default;
-	MoveResult(int32 InFromKey, int32 InToKey, int32 InScore)
-		: FromKey(InFromKey)
-		, ToKey(InToKey)
-		, Score(InScore)
-	{}
-
-	int32 FromKey = -1;
-	int32 ToKey = -1;
-	int32 Score = -1;
-};
 
 UCLASS()
 class HEXACHESS_API UMinimaxAIComponent : public UActorComponent
@@ -39,17 +26,74 @@ class HEXACHESS_API UMinimaxAIComponent : public UActorComponent
 public:
 
 	void BeginPlay() override;
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // queues the engine search (Chess/Search.h) on the shared SearchScheduler and reports back through
+    // ChessGod, the board and History are copied so the search can score repetitions as draws
+    void StartCalculatingMove(Board* ActiveBoard, const GameHistory& History, bool IsWhiteAI, int32 Depth);
+
+	// forgets everything learned during the previous game, called when a new game starts
+	void ResetContext();
+
+	/*
+	 * Once a move is found, keep searching the position after the expected reply
+	 * while the opponent thinks. If the opponent plays it, the answer is already there.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
+	bool bPonder = true;
+
+	/*
+	 * Longest a single search of this match may run, in milliseconds, pondering included.
+	 * Searches of every match share one worker pool, so this bounds how long a match holds a core.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI")
+	int32 SearchTimeBudgetMs = 10000;
 
-    void StartCalculatingMove(Board* ActiveBoard, bool IsWhiteAI, int32 Depth);
+	/*
+	 * Opening book built with hexengine-book, relative to the project content directory.
+	 * Book positions are answered instantly with a weighted random book move.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI")
+	FString OpeningBookFile = TEXT("Books/Hexachess.book");
 
-    // minmax algorithm
-    // - we need to get all the possible moves for the AI
-    // - for each move, we need to get all the possible moves for the player
-    // - repeat the recursion until the depth limit is reached
-    // - evaluate the board state for all bottom nodes (it's recursion exit point)
-    // - keep going up taking other min or max values among the siblings' values
-    // - last step should give you the best move; return it
-	MoveResult MiniMax(Board* ActiveBoard, map<int32, Cell*>& in_board, int32 Depth, bool IsWhitePlayer, int32 Alpha, int32 Beta);
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
+	bool bUseOpeningBook = true;
+
+	// endgame tablebases generated with hexengine-tb, relative to the project content directory
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI")
+	FString TablebaseDirectory = TEXT("Tablebases");
 
 	TWeakObjectPtr<AChessGod> ChessGod;
+
+private:
+
+	// called on the game thread once a move is found, queues a search of PonderBoard after our move and the expected reply
+	void StartPondering(const Move& OurMove, const Move& ExpectedReply, const GameHistory& SearchedHistory, bool IsWhiteAI, int32 Depth);
+
+	// aborts a queued or running ponder search, used when the search can't be reused
+	void StopPondering();
+
+	// Our match in the shared SearchScheduler. Its Search serves both move
+	// searches and pondering so the transposition table, history and killers
+	// carry over, and runs one job at a time.
+	int32 MatchId = 0;
+
+	OpeningBook* AIBook = nullptr;
+	Tablebase* AITablebase = nullptr;
+
+	// bumped by ResetContext, moves found for an older game are dropped
+	int32 SearchGeneration = 0;
+
+	// only touched on the game thread, jobs get a copy of the board
+	Board* PonderBoard = nullptr;
+	bool bPonderPending = false;
+	uint64 PonderHash = 0;
+	int32 PonderDepth = 0;
+	bool bPonderIsWhiteAI = false;
+
+	// written by the ponder job, read by the next job of the match
+	int32 PonderFromKey = -1;
+	int32 PonderToKey = -1;
+	int32 PonderPromotion = 0;
+	FAISearchStats PonderStats;
 };
@@ -0,0 +1,60 @@
+#include "MoveCache.h"
+
+
+const vector<int32>& MoveCache::get_moves(Board& board, int32 key) {
+    auto cell = board.board_map.find(key);
+    if (cell == board.board_map.end() || !cell->second->has_piece()) {
+        return no_moves;
+    }
+
+    Cell::PieceColor pc = cell->second->get_piece_color();
+    update_moves(board, pc);
+    const ColorEntry& entry = get_entry(pc);
+    auto moves = entry.moves_by_piece.find(key);
+    return moves != entry.moves_by_piece.end() ? moves->second : no_moves;
+}
+
+const vector<int32>& MoveCache::get_all_move_keys(Board& board, Cell::PieceColor pc) {
+    if (pc == Cell::PieceColor::absent) {
+        return no_moves;
+    }
+    update_moves(board, pc);
+    return get_entry(pc).all_move_keys;
+}
+
+const CellMask& MoveCache::get_attacked_cells(Board& board, Cell::PieceColor pc) {
+    ColorEntry& entry = get_entry(pc);
+    if (!entry.has_attacks) {
+        entry.attacked_cells = CellMask();
+        for (int32 key : board.get_all_piece_move_keys(pc, true)) {
+            entry.attacked_cells.set(Board::to_cell_index(key));
+        }
+        entry.has_attacks = true;
+    }
+    return entry.attacked_cells;
+}
+
+bool MoveCache::is_under_attack(Board& board, int32 key) {
+    auto cell = board.board_map.find(key);
+    if (cell == board.board_map.end() || !cell->second->has_piece()) {
+        return false;
+    }
+    return get_attacked_cells(board, cell->second->get_opposite_color()).test(Board::to_cell_index(key));
+}
+
+void MoveCache::update_moves(Board& board, Cell::PieceColor pc) {
+    ColorEntry& entry = get_entry(pc);
+    if (entry.has_moves) {
+        return;
+    }
+
+    entry.moves_by_piece.clear();
+    entry.all_move_keys.clear();
+    for (int32 piece_key : board.get_piece_keys(pc)) {
+        list<int32> moves = board.get_valid_moves(piece_key);
+        vector<int32>& piece_moves = entry.moves_by_piece[piece_key];
+        piece_moves.assign(moves.begin(), moves.end());
+        entry.all_move_keys.insert(entry.all_move_keys.end(), moves.begin(), moves.end());
+    }
+    entry.has_moves = true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include "ChessEngine.h"
+
+
+// Legal moves and attacked cells of the main board, computed once per
+// position and color on first use. Anything that changes the board must
+// call invalidate().
+class MoveCache {
+    public:
+
+    void invalidate() {
+        for (auto& entry : entries) {
+            entry.has_moves = false;
+            entry.has_attacks = false;
+        }
+    }
+
+    // legal moves of the piece on key, empty for empty or unknown cells
+    const vector<int32>& get_moves(Board& board, int32 key);
+
+    // every legal move target of a color, one entry per move like Board::get_all_piece_move_keys
+    const vector<int32>& get_all_move_keys(Board& board, Cell::PieceColor pc);
+
+    bool has_valid_moves(Board& board, Cell::PieceColor pc) {
+        return !get_all_move_keys(board, pc).empty();
+    }
+
+    // cells a color can move to ignoring checks, same rule as Board::can_be_captured
+    const CellMask& get_attacked_cells(Board& board, Cell::PieceColor pc);
+
+    // whether the piece on key can be captured by the opposite color
+    bool is_under_attack(Board& board, int32 key);
+
+    private:
+
+    struct ColorEntry {
+        bool has_moves = false;
+        bool has_attacks = false;
+        map<int32, vector<int32>> moves_by_piece;
+        vector<int32> all_move_keys;
+        CellMask attacked_cells;
+    };
+
+    ColorEntry& get_entry(Cell::PieceColor pc) {
+        return entries[pc == Cell::PieceColor::white ? 0 : 1];
+    }
+
+    void update_moves(Board& board, Cell::PieceColor pc);
+
+    ColorEntry entries[2];
+    const vector<int32> no_moves;
+};
@@ -0,0 +1,225 @@
+#include "Notation.h"
+
+
+const char* const initial_position_notation = "b/qbk/n1b1n/r5r/ppppppppp/11/5P5/4P1P4/3P1B1P3/2P2B2P2/1PRNQBKNRP1 w - 0 1";
+
+namespace {
+
+const int32 notation_ranks = 11;
+const int32 notation_files = 11;
+
+inline int32 get_file_height(int32 file) {
+    return HexCoordinates::get_column_height(file);
+}
+
+inline int32 get_notation_key(int32 file, int32 rank_index) {
+    return (file << 8) + rank_index;
+}
+
+char to_piece_char(Cell* cell) {
+    static const char white_pieces[] = " PNBRQK";
+    static const char black_pieces[] = " pnbrqk";
+    const char* pieces = cell->get_piece_color() == Cell::PieceColor::white ? white_pieces : black_pieces;
+    return pieces[cell->get_piece_type()];
+}
+
+bool from_piece_char(char c, Cell::PieceType& pt, Cell::PieceColor& pc) {
+    pc = c >= 'a' ? Cell::PieceColor::black : Cell::PieceColor::white;
+    switch (c | 0x20) {
+        case 'p': pt = Cell::PieceType::pawn; return true;
+        case 'n': pt = Cell::PieceType::knight; return true;
+        case 'b': pt = Cell::PieceType::bishop; return true;
+        case 'r': pt = Cell::PieceType::rook; return true;
+        case 'q': pt = Cell::PieceType::queen; return true;
+        case 'k': pt = Cell::PieceType::king; return true;
+    }
+    return false;
+}
+
+bool fail(string* error, const string& message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+    return false;
+}
+
+bool parse_counter(const char*& c, int32& value) {
+    while (*c == ' ') {
+        c++;
+    }
+    if (*c < '0' || *c > '9') {
+        return false;
+    }
+    value = 0;
+    while (*c >= '0' && *c <= '9') {
+        value = value * 10 + (*c++ - '0');
+    }
+    return true;
+}
+
+}
+
+bool parse_position(Board& board, const string& notation, PositionState& state, string* error) {
+    vector<PiecePlacement> pieces;
+    pieces.reserve(Board::cell_count);
+
+    const char* c = notation.c_str();
+    for (int32 rank = notation_ranks; rank >= 1; rank--) {
+        int32 file = 0;
+        const auto next_file = [&file, rank]() {
+            while (file < notation_files && get_file_height(file) < rank) {
+                file++;
+            }
+        };
+        next_file();
+        while (*c != '/' && *c != ' ' && *c != '\0') {
+            if (*c >= '0' && *c <= '9') {
+                int32 empty = 0;
+                while (*c >= '0' && *c <= '9') {
+                    empty = empty * 10 + (*c++ - '0');
+                }
+                for (int32 i = 0; i < empty; i++) {
+                    if (file >= notation_files) {
+                        return fail(error, "too many cells on rank " + to_string(rank));
+                    }
+                    file++;
+                    next_file();
+                }
+                continue;
+            }
+            Cell::PieceType pt;
+            Cell::PieceColor pc;
+            if (!from_piece_char(*c, pt, pc)) {
+                return fail(error, string("unknown piece '") + *c + "'");
+            }
+            if (file >= notation_files) {
+                return fail(error, "too many cells on rank " + to_string(rank));
+            }
+            pieces.push_back(PiecePlacement{get_notation_key(file, rank - 1), pt, pc});
+            file++;
+            next_file();
+            c++;
+        }
+        if (file != notation_files) {
+            return fail(error, "too few cells on rank " + to_string(rank));
+        }
+        if (rank > 1) {
+            if (*c != '/') {
+                return fail(error, "expected 11 ranks");
+            }
+            c++;
+        }
+    }
+
+    PositionState parsed_state;
+    while (*c == ' ') {
+        c++;
+    }
+    if (*c == 'w' || *c == 'b') {
+        parsed_state.is_white_to_move = *c++ == 'w';
+    } else {
+        return fail(error, "expected side to move");
+    }
+    while (*c == ' ') {
+        c++;
+    }
+    if (*c == '-') {
+        c++;
+    } else if (*c >= 'a' && *c <= 'l') {
+        const char* name = c;
+        while (*c != ' ' && *c != '\0') {
+            c++;
+        }
+        parsed_state.en_passant_key = board.from_cell_name(string(name, c));
+        if (parsed_state.en_passant_key == -1) {
+            return fail(error, "unknown en passant cell " + string(name, c));
+        }
+    }
+    const char* counters = c;
+    if (!parse_counter(c, parsed_state.halfmove_clock) || !parse_counter(c, parsed_state.fullmove_number)) {
+        // the counters are optional
+        c = counters;
+        parsed_state.halfmove_clock = 0;
+        parsed_state.fullmove_number = 1;
+    }
+    while (*c == ' ') {
+        c++;
+    }
+    if (*c != '\0') {
+        return fail(error, "unexpected trailing text");
+    }
+
+    const Cell::PieceColor passed_by = parsed_state.is_white_to_move ? Cell::PieceColor::black : Cell::PieceColor::white;
+    if (parsed_state.en_passant_key != -1) {
+        // the pawn that passed the cell belongs to the side that just moved and stands
+        // right beyond it. Only those cells get cleared again by the next move
+        const int32 pawn_key = board.get_double_step_key(parsed_state.en_passant_key, passed_by);
+        bool has_passed_pawn = false;
+        for (const PiecePlacement& piece : pieces) {
+            if (piece.key == parsed_state.en_passant_key) {
+                has_passed_pawn = false;
+                break;
+            }
+            if (piece.key == pawn_key && piece.pt == Cell::PieceType::pawn && piece.pc == passed_by) {
+                has_passed_pawn = true;
+            }
+        }
+        if (pawn_key == -1 || !has_passed_pawn) {
+            return fail(error, "no pawn just passed the en passant cell " + board.to_cell_name(parsed_state.en_passant_key));
+        }
+    }
+
+    vector<SetupConflict> conflicts;
+    if (!board.setup_pieces(pieces, conflicts)) {
+        // the notation can't place two pieces on a cell, only the king count can be off
+        return fail(error, "each side needs exactly one king");
+    }
+    if (parsed_state.en_passant_key != -1) {
+        board.board_map[parsed_state.en_passant_key]->set_en_passant(passed_by);
+    }
+    state = parsed_state;
+    return true;
+}
+
+string format_position(Board& board, const PositionState& state) {
+    string notation;
+    notation.reserve(96);
+    for (int32 rank = notation_ranks; rank >= 1; rank--) {
+        int32 empty = 0;
+        for (int32 file = 0; file < notation_files; file++) {
+            if (get_file_height(file) < rank) {
+                continue;
+            }
+            Cell* cell = board.board_map[get_notation_key(file, rank - 1)];
+            if (!cell->has_piece()) {
+                empty++;
+                continue;
+            }
+            if (empty > 0) {
+                notation += to_string(empty);
+                empty = 0;
+            }
+            notation += to_piece_char(cell);
+        }
+        if (empty > 0) {
+            notation += to_string(empty);
+        }
+        if (rank > 1) {
+            notation += '/';
+        }
+    }
+    notation += state.is_white_to_move ? " w " : " b ";
+    string en_passant = "-";
+    for (const auto& [key, cell] : board.board_map) {
+        if (cell->get_en_passant() != Cell::PieceColor::absent) {
+            en_passant = board.to_cell_name(key);
+            break;
+        }
+    }
+    notation += en_passant;
+    notation += ' ';
+    notation += to_string(state.halfmove_clock);
+    notation += ' ';
+    notation += to_string(state.fullmove_number);
+    return notation;
+}
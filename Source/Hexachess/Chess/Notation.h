@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+#include "ChessEngine.h"
+
+
+// Compact text notation for Glinski positions, modelled on FEN:
+//
+//   <ranks> <side> <en passant> <halfmove clock> <fullmove number>
+//
+// Ranks run from 11 down to 1 separated by '/'. Each rank lists the cells
+// of that rank from file a to l (files shorter than the rank are skipped),
+// with PNBRQK for white, pnbrqk for black and digits for runs of empty
+// cells. Side is w or b. En passant is the cell the last double pawn step
+// passed, or '-'; it and the two counters may be omitted.
+
+struct PositionState {
+    bool is_white_to_move = true;
+    // -1 when no pawn can be taken en passant
+    int32 en_passant_key = -1;
+    int32 halfmove_clock = 0;
+    int32 fullmove_number = 1;
+};
+
+extern const char* const initial_position_notation;
+
+// the board is left untouched when the notation can't be parsed or has
+// the wrong number of kings, error says why
+bool parse_position(Board& board, const string& notation, PositionState& state, string* error = nullptr);
+
+string format_position(Board& board, const PositionState& state);
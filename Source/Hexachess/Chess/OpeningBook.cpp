@@ -0,0 +1,172 @@
+#include "OpeningBook.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "Notation.h"
+
+namespace {
+
+const char book_magic[4] = {'H', 'X', 'B', 'K'};
+
+struct BookHeader {
+    char magic[4];
+    uint32 version;
+    uint64 entry_count;
+};
+
+static_assert(sizeof(BookHeader) == 16, "the book header is stored as is");
+
+void set_error(string* error, const string& message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+}
+
+}
+
+bool OpeningBook::open(const string& path, string* error) {
+    close();
+    if (!file.open(path, error)) {
+        return false;
+    }
+
+    const BookHeader* header = reinterpret_cast<const BookHeader*>(file.get_data());
+    if (file.get_size() < sizeof(BookHeader) || memcmp(header->magic, book_magic, sizeof(book_magic)) != 0) {
+        close();
+        set_error(error, path + " is not an opening book");
+        return false;
+    }
+    const size_t entries_size = file.get_size() - sizeof(BookHeader);
+    if (header->version != version) {
+        close();
+        set_error(error, path + " has book version " + to_string(header->version) + ", expected " + to_string(version));
+        return false;
+    }
+    if (header->entry_count != entries_size / sizeof(BookEntry) || entries_size % sizeof(BookEntry) != 0) {
+        close();
+        set_error(error, path + " is truncated");
+        return false;
+    }
+
+    // not scanned for order, that would fault in the whole mapping
+    entries = reinterpret_cast<const BookEntry*>(file.get_data() + sizeof(BookHeader));
+    entry_count = header->entry_count;
+    return true;
+}
+
+void OpeningBook::close() {
+    file.close();
+    entries = nullptr;
+    entry_count = 0;
+}
+
+vector<BookMove> OpeningBook::get_moves(Board& board, bool is_white_to_move) {
+    vector<BookMove> moves;
+    if (!is_open()) {
+        return moves;
+    }
+
+    const uint64 key = board.get_hash(is_white_to_move);
+    const BookEntry* last = entries + entry_count;
+    const BookEntry* entry = lower_bound(entries, last, key, [](const BookEntry& e, uint64 k) {
+        return e.key < k;
+    });
+
+    const Cell::PieceColor pc = is_white_to_move ? Cell::PieceColor::white : Cell::PieceColor::black;
+    for (; entry != last && entry->key == key; entry++) {
+        if (entry->from_index >= Board::cell_count || entry->to_index >= Board::cell_count || entry->weight == 0) {
+            continue;
+        }
+        Move move(Board::from_cell_index(entry->from_index), Board::from_cell_index(entry->to_index));
+        if (board.is_legal_move(move, pc)) {
+            moves.push_back(BookMove{move, entry->weight});
+        }
+    }
+    return moves;
+}
+
+Move OpeningBook::pick_move(Board& board, bool is_white_to_move, uint32 random_value) {
+    vector<BookMove> moves = get_moves(board, is_white_to_move);
+    uint32 total_weight = 0;
+    for (const BookMove& book_move : moves) {
+        total_weight += book_move.weight;
+    }
+    if (total_weight == 0) {
+        return Move();
+    }
+
+    uint32 pick = random_value % total_weight;
+    for (const BookMove& book_move : moves) {
+        if (pick < book_move.weight) {
+            return book_move.move;
+        }
+        pick -= book_move.weight;
+    }
+    return moves.back().move;
+}
+
+bool OpeningBookBuilder::add_game(const vector<string>& move_names, GameResult result, int32 max_plies, string* error) {
+    Board board;
+    PositionState state;
+    parse_position(board, initial_position_notation, state);
+
+    bool is_white_to_move = state.is_white_to_move;
+    const int32 plies = std::min(max_plies, static_cast<int32>(move_names.size()));
+    for (int32 ply = 0; ply < plies; ply++) {
+        Move move = board.from_move_name(move_names[ply]);
+        const Cell::PieceColor pc = is_white_to_move ? Cell::PieceColor::white : Cell::PieceColor::black;
+        if (!board.is_legal_move(move, pc)) {
+            set_error(error, "illegal move " + move_names[ply] + " at ply " + to_string(ply + 1));
+            return false;
+        }
+
+        uint32 weight = 1;
+        if (result == white_wins || result == black_wins) {
+            weight = (result == white_wins) == is_white_to_move ? 2 : 0;
+        }
+        const uint16 packed_move = static_cast<uint16>(Board::to_cell_index(move.from_key) << 8 | Board::to_cell_index(move.to_key));
+        weights[make_pair(board.get_hash(is_white_to_move), packed_move)] += weight;
+
+        board.make_move(move);
+        is_white_to_move = !is_white_to_move;
+    }
+    return true;
+}
+
+bool OpeningBookBuilder::save(const string& path, uint32 min_weight, string* error) const {
+    // the map is ordered by hash and packed move, which is the book order
+    vector<BookEntry> entries;
+    for (const auto& [position_move, weight] : weights) {
+        if (weight < std::max(min_weight, 1u)) {
+            continue;
+        }
+        BookEntry entry;
+        entry.key = position_move.first;
+        entry.from_index = static_cast<uint8>(position_move.second >> 8);
+        entry.to_index = static_cast<uint8>(position_move.second & 0xff);
+        entry.weight = static_cast<uint16>(std::min(weight, 0xffffu));
+        entry.reserved = 0;
+        entries.push_back(entry);
+    }
+
+    BookHeader header;
+    memcpy(header.magic, book_magic, sizeof(book_magic));
+    header.version = OpeningBook::version;
+    header.entry_count = entries.size();
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        set_error(error, "can't write " + path);
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (written && !entries.empty()) {
+        written = fwrite(entries.data(), sizeof(BookEntry), entries.size(), file) == entries.size();
+    }
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        set_error(error, "can't write " + path);
+    }
+    return written;
+}
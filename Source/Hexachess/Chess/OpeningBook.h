@@ -0,0 +1,100 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ChessEngine.h"
+#include "MappedFile.h"
+
+
+// Opening book stored as a sorted array of fixed size entries:
+//
+//   header   "HXBK", uint32 version, uint64 entry count
+//   entries  uint64 position hash (Board::get_hash), uint8 from cell index,
+//            uint8 to cell index, uint16 weight, uint32 reserved
+//
+// Entries are sorted by hash, then by move, and stored in the byte order
+// of the machine that built the book, little endian on every platform we
+// ship; a book built on a big endian host won't load elsewhere. The file
+// is memory-mapped as is and looked up with a binary search, so opening
+// it costs nothing however large the book is. The order is trusted, not
+// checked: OpeningBookBuilder::save writes it sorted.
+
+struct BookEntry {
+    uint64 key;
+    uint8 from_index;
+    uint8 to_index;
+    uint16 weight;
+    uint32 reserved;
+};
+
+static_assert(sizeof(BookEntry) == 16, "book entries are stored as is");
+
+struct BookMove {
+    Move move;
+    uint16 weight = 0;
+};
+
+class OpeningBook {
+    public:
+
+    // entries are keyed by Board::get_hash, so any change to the hash needs a new version
+    static const uint32 version = 2;
+
+    // the previous book, if any, is closed first
+    bool open(const string& path, string* error = nullptr);
+    void close();
+
+    bool is_open() const {
+        return entries != nullptr;
+    }
+
+    uint64 get_entry_count() const {
+        return entry_count;
+    }
+
+    // legal book moves of the position, a hash collision never yields an illegal move
+    vector<BookMove> get_moves(Board& board, bool is_white_to_move);
+
+    // weighted choice between the book moves, random_value should be uniformly
+    // distributed; an invalid move when the position is not in the book
+    Move pick_move(Board& board, bool is_white_to_move, uint32 random_value);
+
+    private:
+
+    MappedFile file;
+    const BookEntry* entries = nullptr;
+    uint64 entry_count = 0;
+};
+
+// Collects positions and moves from game logs and writes them as a book.
+class OpeningBookBuilder {
+    public:
+
+    enum GameResult {
+        unknown,
+        white_wins,
+        black_wins,
+        draw
+    };
+
+    // Records the first max_plies moves of a game played from the initial
+    // position. Moves of the winning side weigh 2, moves of the losing side
+    // nothing and everything else 1. Fails on the first illegal move, the
+    // moves before it are kept.
+    bool add_game(const vector<string>& move_names, GameResult result, int32 max_plies, string* error = nullptr);
+
+    // moves below min_weight are left out
+    bool save(const string& path, uint32 min_weight, string* error = nullptr) const;
+
+    size_t get_move_count() const {
+        return weights.size();
+    }
+
+    private:
+
+    // (position hash, from index << 8 | to index) -> weight
+    map<pair<uint64, uint16>, uint32> weights;
+};
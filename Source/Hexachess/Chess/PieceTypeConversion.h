@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ChessEngine.h"
+#include "Types/PieceType.h"
+
+
+// Conversions between the engine's piece types and colours and the game's.
+
+inline Cell::PieceType ToEnginePieceType(EPieceType Type)
+{
+    switch (Type)
+    {
+    case EPieceType::Pawn:
+        return Cell::PieceType::pawn;
+    case EPieceType::Knight:
+        return Cell::PieceType::knight;
+    case EPieceType::Bishop:
+        return Cell::PieceType::bishop;
+    case EPieceType::Rook:
+        return Cell::PieceType::rook;
+    case EPieceType::Queen:
+        return Cell::PieceType::queen;
+    case EPieceType::King:
+        return Cell::PieceType::king;
+    default:
+        return Cell::PieceType::pawn;
+    }
+}
+
+inline EPieceType ToPieceType(Cell::PieceType Type)
+{
+    switch (Type)
+    {
+    case Cell::PieceType::knight:
+        return EPieceType::Knight;
+    case Cell::PieceType::bishop:
+        return EPieceType::Bishop;
+    case Cell::PieceType::rook:
+        return EPieceType::Rook;
+    case Cell::PieceType::queen:
+        return EPieceType::Queen;
+    case Cell::PieceType::king:
+        return EPieceType::King;
+    default:
+        return EPieceType::Pawn;
+    }
+}
+
+inline Cell::PieceColor ToEnginePieceColor(int32 TeamID)
+{
+    return TeamID == 0 ? Cell::PieceColor::white : Cell::PieceColor::black;
+}
+
+// a pawn may only promote to one of these
+inline bool IsPromotionPieceType(EPieceType Type)
+{
+    return Type == EPieceType::Queen || Type == EPieceType::Rook || Type == EPieceType::Bishop || Type == EPieceType::Knight;
+}
+
+// moves that don't promote report the queen, MovePiece ignores it for them
+inline EPieceType ToPromotionPieceType(Cell::PieceType Promotion)
+{
+    switch (Promotion)
+    {
+    case Cell::PieceType::knight:
+        return EPieceType::Knight;
+    case Cell::PieceType::bishop:
+        return EPieceType::Bishop;
+    case Cell::PieceType::rook:
+        return EPieceType::Rook;
+    default:
+        return EPieceType::Queen;
+    }
+}
@@ -0,0 +1,162 @@
+#include "Replay.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char replay_magic[4] = {'H', 'X', 'R', 'P'};
+
+struct ReplayHeader {
+    char magic[4];
+    uint32 version;
+    uint32 notation_length;
+    uint32 move_count;
+};
+
+static_assert(sizeof(ReplayHeader) == 16, "the replay header is stored as is");
+
+// room for most games, longer ones reallocate as they go
+const size_t reserved_plies = 512;
+
+void set_error(string* error, const string& message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+}
+
+}
+
+void Replay::start(const string& in_initial_notation, chrono::steady_clock::time_point started_at) {
+    initial_notation = in_initial_notation;
+    moves.clear();
+    moves.reserve(reserved_plies);
+    start_time = started_at;
+}
+
+vector<uint8> Replay::to_bytes() const {
+    ReplayHeader header;
+    memcpy(header.magic, replay_magic, sizeof(replay_magic));
+    header.version = version;
+    header.notation_length = static_cast<uint32>(initial_notation.size());
+    header.move_count = static_cast<uint32>(moves.size());
+
+    vector<uint8> bytes(sizeof(header) + initial_notation.size() + moves.size() * sizeof(ReplayMove));
+    uint8* out = bytes.data();
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    memcpy(out, initial_notation.data(), initial_notation.size());
+    out += initial_notation.size();
+    if (!moves.empty()) {
+        memcpy(out, moves.data(), moves.size() * sizeof(ReplayMove));
+    }
+    return bytes;
+}
+
+bool Replay::from_bytes(const uint8* data, size_t size, string* error) {
+    ReplayHeader header;
+    if (size < sizeof(header)) {
+        set_error(error, "not a replay");
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, replay_magic, sizeof(replay_magic)) != 0) {
+        set_error(error, "not a replay");
+        return false;
+    }
+    if (header.version != version) {
+        set_error(error, "replay version " + to_string(header.version) + ", expected " + to_string(version));
+        return false;
+    }
+    if (size != sizeof(header) + header.notation_length + static_cast<size_t>(header.move_count) * sizeof(ReplayMove)) {
+        set_error(error, "the replay is truncated");
+        return false;
+    }
+
+    const uint8* in = data + sizeof(header);
+    initial_notation.assign(reinterpret_cast<const char*>(in), header.notation_length);
+    in += header.notation_length;
+    moves.resize(header.move_count);
+    if (header.move_count > 0) {
+        memcpy(moves.data(), in, moves.size() * sizeof(ReplayMove));
+    }
+    start_time = chrono::steady_clock::now() - chrono::milliseconds(moves.empty() ? 0 : moves.back().time_ms);
+    return true;
+}
+
+bool Replay::save(const string& path, string* error) const {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        set_error(error, "can't write " + path);
+        return false;
+    }
+    const vector<uint8> bytes = to_bytes();
+    const bool is_written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    if (fclose(file) != 0 || !is_written) {
+        set_error(error, "can't write " + path);
+        return false;
+    }
+    return true;
+}
+
+bool Replay::load(const string& path, string* error) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        set_error(error, "can't open " + path);
+        return false;
+    }
+    vector<uint8> bytes;
+    uint8 buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + read);
+    }
+    fclose(file);
+
+    if (!from_bytes(bytes.data(), bytes.size(), error)) {
+        if (error != nullptr) {
+            *error = path + ": " + *error;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool ReplayPlayer::open(const Replay* in_replay, string* error) {
+    PositionState state;
+    if (!parse_position(board, in_replay->get_initial_notation(), state, error)) {
+        return false;
+    }
+    replay = in_replay;
+    initial_state = state;
+    ply = 0;
+    last_move = Move();
+    return true;
+}
+
+bool ReplayPlayer::seek(int32 target_ply, string* error) {
+    if (replay == nullptr) {
+        set_error(error, "no replay is open");
+        return false;
+    }
+    target_ply = max(0, min(target_ply, replay->get_ply_count()));
+    if (target_ply < ply) {
+        // the board can't go back, start over
+        PositionState state;
+        parse_position(board, replay->get_initial_notation(), state);
+        ply = 0;
+        last_move = Move();
+    }
+
+    const vector<ReplayMove>& moves = replay->get_moves();
+    for (; ply < target_ply; ply++) {
+        const Move move = board.unpack_move(moves[ply].move);
+        if (!board.is_legal_move(move, is_white_to_move() ? Cell::PieceColor::white : Cell::PieceColor::black)) {
+            set_error(error, "illegal move at ply " + to_string(ply + 1));
+            return false;
+        }
+        board.make_move(move);
+        last_move = move;
+    }
+    return true;
+}
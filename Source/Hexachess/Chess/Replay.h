@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ChessEngine.h"
+#include "Notation.h"
+
+
+// Move log of one game, stored as:
+//
+//   header    "HXRP", uint32 version, uint32 notation length, uint32 move count
+//   notation  the initial position (Notation.h), not terminated
+//   moves     uint16 packed move (Board::pack_move), uint16 reserved,
+//             uint32 milliseconds since the recording started
+//
+// Everything is little endian. Recording a move appends 8 bytes to a
+// vector reserved up front, so it costs next to nothing during a game.
+
+struct ReplayMove {
+    uint16 move;
+    uint16 reserved;
+    uint32 time_ms;
+};
+
+static_assert(sizeof(ReplayMove) == 8, "replay moves are stored as is");
+
+class Replay {
+    public:
+
+    static const uint32 version = 1;
+
+    // drops the moves recorded so far and restarts the clock, from started_at when the game began earlier
+    void start(const string& in_initial_notation, chrono::steady_clock::time_point started_at = chrono::steady_clock::now());
+
+    void record(uint16 packed_move) {
+        const auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start_time);
+        record(packed_move, static_cast<uint32>(elapsed.count()));
+    }
+
+    void record(uint16 packed_move, uint32 time_ms) {
+        moves.push_back(ReplayMove{packed_move, 0, time_ms});
+    }
+
+    const string& get_initial_notation() const {
+        return initial_notation;
+    }
+
+    const vector<ReplayMove>& get_moves() const {
+        return moves;
+    }
+
+    int32 get_ply_count() const {
+        return static_cast<int32>(moves.size());
+    }
+
+    vector<uint8> to_bytes() const;
+
+    // The replay is left untouched when the data is not a replay. Moves
+    // recorded after loading are timed as if the recording never stopped.
+    bool from_bytes(const uint8* data, size_t size, string* error = nullptr);
+
+    bool save(const string& path, string* error = nullptr) const;
+    bool load(const string& path, string* error = nullptr);
+
+    private:
+
+    string initial_notation;
+    vector<ReplayMove> moves;
+    chrono::steady_clock::time_point start_time;
+};
+
+// Plays a replay back on its own board. Seeking replays the moves on the
+// engine only, forward from the current ply or from the start when going
+// back, so any ply is reached in microseconds.
+class ReplayPlayer {
+    public:
+
+    // the replay must outlive the player; false when its initial position doesn't parse
+    bool open(const Replay* in_replay, string* error = nullptr);
+
+    // Moves to the position after the given number of plies, clamped to
+    // the replay. False when a recorded move is illegal, the board then
+    // stays on the ply before it.
+    bool seek(int32 ply, string* error = nullptr);
+
+    int32 get_ply() const {
+        return ply;
+    }
+
+    bool is_white_to_move() const {
+        return initial_state.is_white_to_move == (ply % 2 == 0);
+    }
+
+    // counted up after every black move, from the one of the initial position
+    int32 get_fullmove_number() const {
+        return initial_state.fullmove_number + (ply + (initial_state.is_white_to_move ? 0 : 1)) / 2;
+    }
+
+    Board& get_board() {
+        return board;
+    }
+
+    // the move that led to the current ply, invalid at ply 0
+    Move get_last_move() const {
+        return last_move;
+    }
+
+    private:
+
+    const Replay* replay = nullptr;
+    Board board;
+    PositionState initial_state;
+    int32 ply = 0;
+    Move last_move;
+};
@@ -0,0 +1,390 @@
+#include "Search.h"
+
+
+SearchResult Search::find_best_move(Board& board, bool is_white_player, int32 depth) {
+    HEXENGINE_SCOPE_CYCLE_COUNTER(STAT_HexachessSearch);
+
+    // the per ply tables only go max_depth deep, and a fixed depth search isn't meant to be stopped
+    depth = std::min(depth, static_cast<int32>(max_depth));
+    stats = SearchStats();
+    root_depth = depth;
+    limits = SearchLimits();
+    start_time = chrono::steady_clock::now();
+    aborted = false;
+    reset_stop();
+    key_count = game_key_count;
+
+    // search on a private copy so the game thread can keep using the main board
+    auto board_copy = board.copy_board_map();
+    SearchResult result = minimax(board, board_copy, depth, is_white_player, -infinity, infinity);
+    board.clear_board_map(board_copy);
+    stats.depth_reached = aborted ? 0 : depth;
+    return result;
+}
+
+SearchResult Search::think(Board& board, bool is_white_player, const SearchLimits& in_limits, const function<void(const SearchInfo&)>& on_info) {
+    HEXENGINE_SCOPE_CYCLE_COUNTER(STAT_HexachessSearch);
+
+    stats = SearchStats();
+    limits = in_limits;
+    if (time_budget_ms > 0 && (limits.movetime_ms <= 0 || limits.movetime_ms > time_budget_ms)) {
+        limits.movetime_ms = time_budget_ms;
+    }
+    start_time = chrono::steady_clock::now();
+    aborted = false;
+    key_count = game_key_count;
+
+    int32 last_depth = limits.depth > 0 ? std::min(limits.depth, static_cast<int32>(max_depth)) : max_depth;
+    SearchResult best;
+    auto board_copy = board.copy_board_map();
+    for (root_depth = 1; root_depth <= last_depth; root_depth++) {
+        SearchResult result = minimax(board, board_copy, root_depth, is_white_player, -infinity, infinity);
+        if (aborted) {
+            break;
+        }
+        best = result;
+        stats.depth_reached = root_depth;
+
+        if (on_info) {
+            SearchInfo info;
+            info.depth = root_depth;
+            info.score = result.score;
+            info.nodes = stats.nodes;
+            info.seconds = get_elapsed_seconds();
+            info.pv = get_pv(board, board_copy, is_white_player, root_depth);
+            on_info(info);
+        }
+
+        // nothing left to search without a legal move or once a mate is found
+        if (result.from_key == -1 || std::abs(result.score) >= infinity) {
+            break;
+        }
+    }
+    board.clear_board_map(board_copy);
+    return best;
+}
+
+bool Search::should_stop() {
+    if (aborted) {
+        return true;
+    }
+    // the first iteration always completes so there is a move to play
+    if (root_depth <= 1) {
+        return false;
+    }
+    if (stop_requested || (limits.nodes > 0 && stats.nodes >= limits.nodes)) {
+        aborted = true;
+    } else if (limits.movetime_ms > 0 && (stats.nodes & 15) == 0) {
+        aborted = get_elapsed_seconds() * 1000.0 >= limits.movetime_ms;
+    }
+    return aborted;
+}
+
+vector<Move> Search::get_pv(Board& board, map<int32, Cell*>& in_board, bool is_white_player, int32 depth) {
+    vector<Move> pv;
+    auto board_copy = board.copy_board_map(in_board);
+    for (int32 ply = 0; ply < depth; ply++) {
+        const TranspositionEntry* entry = tt.probe(board.get_hash(board_copy, is_white_player));
+        const Move move = entry != nullptr ? board.unpack_move(board_copy, entry->move) : Move();
+        if (!move.is_valid()) {
+            break;
+        }
+
+        // only follow moves that are still legal, a hash collision must not corrupt the line
+        Cell::PieceColor pc = is_white_player ? Cell::PieceColor::white : Cell::PieceColor::black;
+        if (board_copy[move.from_key]->get_piece_color() != pc) {
+            break;
+        }
+        list<int32> moves = board.get_valid_moves(board_copy, move.from_key);
+        if (find(moves.begin(), moves.end(), move.to_key) == moves.end()) {
+            break;
+        }
+
+        pv.push_back(move);
+        board.make_move(board_copy, move);
+        is_white_player = !is_white_player;
+    }
+    board.clear_board_map(board_copy);
+    return pv;
+}
+
+double Search::get_elapsed_seconds() const {
+    return chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+}
+
+void Search::set_game_history(const GameHistory& game_history) {
+    const vector<uint64>& hashes = game_history.get_hashes();
+    root_halfmove_clock = game_history.get_halfmove_clock();
+
+    // older positions can't repeat, the searched position itself is pushed by the root
+    const int32 last = static_cast<int32>(hashes.size()) - 1;
+    game_key_count = std::max(0, std::min({root_halfmove_clock, static_cast<int32>(GameHistory::fifty_move_plies), last}));
+    for (int32 i = 0; i < game_key_count; i++) {
+        key_stack[i] = hashes[last - game_key_count + i];
+        halfmove_clocks[i] = root_halfmove_clock - game_key_count + i;
+    }
+}
+
+bool Search::push_key(uint64 hash, int32 depth) {
+    int32 halfmove_clock = root_halfmove_clock;
+    if (depth != root_depth) {
+        halfmove_clock = is_next_irreversible ? 0 : halfmove_clocks[key_count - 1] + 1;
+    }
+    const int32 index = key_count++;
+    key_stack[index] = hash;
+    halfmove_clocks[index] = halfmove_clock;
+
+    if (halfmove_clock >= GameHistory::fifty_move_plies) {
+        return true;
+    }
+    for (int32 i = index - 2; i >= 0 && i >= index - halfmove_clock; i -= 2) {
+        if (key_stack[i] == hash) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SearchResult Search::minimax(Board& board, map<int32, Cell*>& in_board, int32 depth, bool is_white_player, int32 alpha, int32 beta) {
+    if (should_stop()) {
+        return SearchResult();
+    }
+    stats.nodes++;
+
+    uint64 hash = board.get_hash(in_board, is_white_player);
+    bool is_draw = push_key(hash, depth);
+    SearchResult result;
+    if (is_draw && depth != root_depth) {
+        result = SearchResult(0, 0, 0);
+    } else {
+        result = search_node(board, in_board, hash, depth, is_white_player, alpha, beta);
+    }
+    pop_key();
+    return result;
+}
+
+SearchResult Search::search_node(Board& board, map<int32, Cell*>& in_board, uint64 hash, int32 depth, bool is_white_player, int32 alpha, int32 beta) {
+    // the root still needs a move
+    if (tablebase != nullptr && depth < root_depth) {
+        TablebaseResult tablebase_result;
+        if (tablebase->probe(in_board, is_white_player, tablebase_result)) {
+            stats.tb_hits++;
+            int32 score = 0;
+            if (tablebase_result.outcome != TablebaseResult::draw) {
+                score = tablebase_win_score - tablebase_result.plies_to_mate;
+                score = (tablebase_result.outcome == TablebaseResult::win) == is_white_player ? score : -score;
+            }
+            return SearchResult(0, 0, score);
+        }
+    }
+
+    if (depth == 0) {
+        return SearchResult(0, 0, board.evaluate(in_board));
+    }
+
+    const TranspositionEntry* entry = nullptr;
+    {
+        HEXENGINE_SCOPE_CYCLE_COUNTER(STAT_HexachessTTProbe);
+        stats.tt_probes++;
+        entry = tt.probe(hash);
+    }
+    Move tt_move;
+    if (entry != nullptr) {
+        stats.tt_hits++;
+        tt_move = board.unpack_move(in_board, entry->move);
+        // the root always searches so it can report a move
+        if (entry->depth >= depth && depth != root_depth) {
+            SearchResult tt_result(tt_move, entry->score);
+            switch (entry->bound) {
+                case TranspositionEntry::Bound::exact:
+                    return tt_result;
+                case TranspositionEntry::Bound::lower:
+                    alpha = std::max(alpha, entry->score);
+                    break;
+                case TranspositionEntry::Bound::upper:
+                    beta = std::min(beta, entry->score);
+                    break;
+                default:
+                    break;
+            }
+            if (beta <= alpha) {
+                return tt_result;
+            }
+        }
+    }
+    const int32 window_alpha = alpha;
+    const int32 window_beta = beta;
+
+    const int32 ply = root_depth - depth;
+    vector<Move> moves = get_ordered_moves(board, in_board, is_white_player, ply, tt_move);
+
+    SearchResult result;
+    if (is_white_player) {
+        int32 max_eval = -infinity;
+        for (const Move& move : moves) {
+            auto board_copy = board.copy_board_map(in_board);
+            board.make_move(board_copy, move);
+            is_next_irreversible = board.is_irreversible_move(in_board, move);
+            SearchResult child_result = minimax(board, board_copy, depth - 1, false, alpha, beta);
+
+            board.clear_board_map(board_copy);
+            if (aborted) {
+                return result;
+            }
+            if (child_result.score > max_eval) {
+                result.from_key = move.from_key;
+                result.to_key = move.to_key;
+                result.promotion = move.promotion;
+            }
+            max_eval = std::max(max_eval, child_result.score);
+
+            // pruning
+            alpha = std::max(alpha, child_result.score);
+            if (beta <= alpha) {
+                stats.cutoffs++;
+                update_cutoff_tables(in_board, move, is_white_player, ply, depth);
+                break;
+            }
+        }
+        result.score = max_eval;
+        if (max_eval <= window_alpha) {
+            tt.store(hash, depth, max_eval, TranspositionEntry::Bound::upper, Board::pack_move(result.get_move()));
+        } else if (max_eval >= beta) {
+            tt.store(hash, depth, max_eval, TranspositionEntry::Bound::lower, Board::pack_move(result.get_move()));
+        } else {
+            tt.store(hash, depth, max_eval, TranspositionEntry::Bound::exact, Board::pack_move(result.get_move()));
+        }
+    } else {
+        int32 min_eval = infinity;
+        for (const Move& move : moves) {
+            auto board_copy = board.copy_board_map(in_board);
+            board.make_move(board_copy, move);
+            is_next_irreversible = board.is_irreversible_move(in_board, move);
+            SearchResult child_result = minimax(board, board_copy, depth - 1, true, alpha, beta);
+
+            board.clear_board_map(board_copy);
+            if (aborted) {
+                return result;
+            }
+            if (child_result.score < min_eval) {
+                result.from_key = move.from_key;
+                result.to_key = move.to_key;
+                result.promotion = move.promotion;
+            }
+            min_eval = std::min(min_eval, child_result.score);
+
+            // pruning
+            beta = std::min(beta, child_result.score);
+            if (beta <= alpha) {
+                stats.cutoffs++;
+                update_cutoff_tables(in_board, move, is_white_player, ply, depth);
+                break;
+            }
+        }
+        result.score = min_eval;
+        if (min_eval >= window_beta) {
+            tt.store(hash, depth, min_eval, TranspositionEntry::Bound::lower, Board::pack_move(result.get_move()));
+        } else if (min_eval <= alpha) {
+            tt.store(hash, depth, min_eval, TranspositionEntry::Bound::upper, Board::pack_move(result.get_move()));
+        } else {
+            tt.store(hash, depth, min_eval, TranspositionEntry::Bound::exact, Board::pack_move(result.get_move()));
+        }
+    }
+
+    return result;
+}
+
+void Search::clear() {
+    tt.clear();
+    std::fill(&history[0][0][0], &history[0][0][0] + sizeof(history) / sizeof(int32), 0);
+    for (auto& ply_killers : killers) {
+        ply_killers[0] = Move();
+        ply_killers[1] = Move();
+    }
+}
+
+void Search::age() {
+    tt.new_generation();
+
+    for (auto& color_history : history) {
+        for (auto& from_history : color_history) {
+            for (int32& score : from_history) {
+                score /= 2;
+            }
+        }
+    }
+
+    // the next search starts two plies later, a killer at ply 2 now lives at ply 0
+    for (int32 ply = 0; ply < max_depth; ply++) {
+        killers[ply][0] = ply + 2 < max_depth ? killers[ply + 2][0] : Move();
+        killers[ply][1] = ply + 2 < max_depth ? killers[ply + 2][1] : Move();
+    }
+}
+
+vector<Move> Search::get_ordered_moves(Board& board, map<int32, Cell*>& in_board, bool is_white_player, int32 ply, const Move& tt_move) {
+    struct ScoredMove {
+        Move move;
+        int32 score;
+    };
+
+    const int32 color_index = is_white_player ? 0 : 1;
+    vector<ScoredMove> scored_moves;
+    for (const Move& move : board.get_legal_moves(in_board, is_white_player ? Cell::PieceColor::white : Cell::PieceColor::black)) {
+        int32 score = history[color_index][Board::to_cell_index(move.from_key)][Board::to_cell_index(move.to_key)];
+        Cell* victim = in_board[move.to_key];
+        if (move == tt_move) {
+            score = tt_move_score;
+        } else if (!is_quiet(in_board, move)) {
+            // most valuable victim and promotion first, cheapest attacker first among equal ones
+            int32 gain = victim->has_piece() ? board.piece_values[victim->get_piece_type()] : 0;
+            if (Board::is_en_passant_move(in_board, move.from_key, move.to_key)) {
+                gain = board.piece_values[Cell::PieceType::pawn];
+            }
+            if (move.promotion != Cell::PieceType::none) {
+                gain += board.piece_values[move.promotion];
+            }
+            score = capture_score + gain * 128 - board.piece_values[in_board[move.from_key]->get_piece_type()];
+        } else if (is_killer(move, ply)) {
+            score = killer_score - (killers[ply][0] == move ? 0 : 1);
+        }
+        scored_moves.push_back(ScoredMove{move, score});
+    }
+
+    stable_sort(scored_moves.begin(), scored_moves.end(), [](const ScoredMove& a, const ScoredMove& b) {
+        return a.score > b.score;
+    });
+
+    vector<Move> moves;
+    moves.reserve(scored_moves.size());
+    for (const ScoredMove& scored_move : scored_moves) {
+        moves.push_back(scored_move.move);
+    }
+    return moves;
+}
+
+bool Search::is_killer(const Move& move, int32 ply) const {
+    if (ply >= max_depth) {
+        return false;
+    }
+    for (const Move& killer : killers[ply]) {
+        if (killer == move) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Search::update_cutoff_tables(map<int32, Cell*>& in_board, const Move& move, bool is_white_player, int32 ply, int32 depth) {
+    // captures and promotions are ordered by value already
+    if (!is_quiet(in_board, move)) {
+        return;
+    }
+
+    if (ply < max_depth && killers[ply][0] != move) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+
+    int32& score = history[is_white_player ? 0 : 1][Board::to_cell_index(move.from_key)][Board::to_cell_index(move.to_key)];
+    score = std::min(score + depth * depth, max_history_score);
+}
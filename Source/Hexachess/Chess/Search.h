@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include "ChessEngine.h"
+#include "GameHistory.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
+
+
+struct SearchResult {
+
+    SearchResult() {}
+    SearchResult(int32 from_key, int32 to_key, int32 score): from_key(from_key), to_key(to_key), score(score) {}
+    SearchResult(const Move& move, int32 score): from_key(move.from_key), to_key(move.to_key), promotion(move.promotion), score(score) {}
+
+    Move get_move() const {
+        return Move(from_key, to_key, promotion);
+    }
+
+    int32 from_key = -1;
+    int32 to_key = -1;
+    Cell::PieceType promotion = Cell::PieceType::none;
+    int32 score = -1;
+};
+
+struct SearchStats {
+    uint64 nodes = 0;
+    uint64 cutoffs = 0;
+    uint64 tt_probes = 0;
+    uint64 tt_hits = 0;
+    uint64 tb_hits = 0;
+    int32 depth_reached = 0;
+};
+
+// zero means no limit, the search stops at the first limit it reaches
+struct SearchLimits {
+    int32 depth = 0;
+    int64 movetime_ms = 0;
+    uint64 nodes = 0;
+};
+
+// reported by think() after every completed iteration
+struct SearchInfo {
+    int32 depth = 0;
+    int32 score = 0;
+    uint64 nodes = 0;
+    double seconds = 0.0;
+    vector<Move> pv;
+};
+
+class Search {
+    public:
+
+    static const int32 infinity = 9000;
+    static const int32 max_depth = 32;
+    // tablebase wins score this minus the plies to mate, above any material balance
+    static const int32 tablebase_win_score = 5000;
+
+    // fixed depth search, at most max_depth deep, that ignores a stop() from before the call
+    SearchResult find_best_move(Board& board, bool is_white_player, int32 depth);
+
+    // iterative deepening within limits, the result of the last completed iteration is returned
+    SearchResult think(Board& board, bool is_white_player, const SearchLimits& limits, const function<void(const SearchInfo&)>& on_info = nullptr);
+
+    // best line from board as stored by the previous searches, only legal moves are followed
+    vector<Move> get_pv(Board& board, bool is_white_player, int32 max_length) {
+        return get_pv(board, board.board_map, is_white_player, max_length);
+    }
+
+    // Tables learned by earlier searches (transposition table, history and
+    // killer moves) are kept between calls so consecutive moves of a game
+    // reuse the work. age() once per move played ages them; clear() forgets
+    // everything, for a new game.
+    void age();
+    void clear();
+
+    // Positions of the game up to and including the one about to be
+    // searched. Below the root a position repeating one of them or an
+    // earlier one of the line, or reached after fifty moves without a
+    // capture or pawn move, scores as a draw. Kept until the next call.
+    void set_game_history(const GameHistory& game_history);
+
+    // caps the movetime of every think() call, 0 for no cap; find_best_move is never cut short
+    void set_time_budget(int64 budget_ms) {
+        time_budget_ms = budget_ms;
+    }
+
+    // small endings below the root are scored from the tablebase, nullptr to search them
+    void set_tablebase(const Tablebase* in_tablebase) {
+        tablebase = in_tablebase;
+    }
+
+    // safe to call from another thread, the search returns as soon as it notices
+    void stop() {
+        stop_requested = true;
+    }
+
+    // must be called before starting a search that may later be stopped
+    void reset_stop() {
+        stop_requested = false;
+    }
+
+    const SearchStats& get_stats() const {
+        return stats;
+    }
+
+    private:
+
+    // minmax algorithm
+    // - we need to get all the possible moves for the AI
+    // - for each move, we need to get all the possible moves for the player
+    // - repeat the recursion until the depth limit is reached
+    // - evaluate the board state for all bottom nodes (it's recursion exit point)
+    // - keep going up taking other min or max values among the siblings' values
+    // - last step should give you the best move; return it
+    SearchResult minimax(Board& board, map<int32, Cell*>& in_board, int32 depth, bool is_white_player, int32 alpha, int32 beta);
+    SearchResult search_node(Board& board, map<int32, Cell*>& in_board, uint64 hash, int32 depth, bool is_white_player, int32 alpha, int32 beta);
+
+    // adds the node to the key stack, true when it is a draw by repetition or the fifty-move rule
+    bool push_key(uint64 hash, int32 depth);
+
+    void pop_key() {
+        key_count--;
+    }
+
+    bool should_stop();
+
+    // all legal moves, transposition table move first, then captures, killers and history
+    vector<Move> get_ordered_moves(Board& board, map<int32, Cell*>& in_board, bool is_white_player, int32 ply, const Move& tt_move);
+
+    bool is_killer(const Move& move, int32 ply) const;
+
+    // neither a capture, en passant included, nor a promotion
+    static bool is_quiet(map<int32, Cell*>& in_board, const Move& move) {
+        return !in_board[move.to_key]->has_piece()
+               && move.promotion == Cell::PieceType::none
+               && !Board::is_en_passant_move(in_board, move.from_key, move.to_key);
+    }
+
+    // remembers a quiet move that caused a cutoff
+    void update_cutoff_tables(map<int32, Cell*>& in_board, const Move& move, bool is_white_player, int32 ply, int32 depth);
+
+    // follows the best moves stored in the transposition table
+    vector<Move> get_pv(Board& board, map<int32, Cell*>& in_board, bool is_white_player, int32 depth);
+
+    double get_elapsed_seconds() const;
+
+    static constexpr int32 tt_move_score = 1 << 30;
+    static constexpr int32 capture_score = 1 << 28;
+    static constexpr int32 killer_score = 1 << 26;
+    static constexpr int32 max_history_score = 1 << 24;
+    static constexpr int32 key_stack_size = GameHistory::fifty_move_plies + max_depth + 2;
+
+    SearchStats stats;
+    TranspositionTable tt;
+    const Tablebase* tablebase = nullptr;
+    int32 root_depth = 0;
+
+    // [color][from cell index][to cell index]
+    int32 history[2][Board::cell_count][Board::cell_count] = {};
+    Move killers[max_depth][2];
+
+    // hashes of the game since the last irreversible move, then of the line being searched
+    uint64 key_stack[key_stack_size];
+    int32 halfmove_clocks[key_stack_size];
+    int32 key_count = 0;
+    int32 game_key_count = 0;
+    int32 root_halfmove_clock = 0;
+    // set right before searching a child
+    bool is_next_irreversible = false;
+
+    SearchLimits limits;
+    int64 time_budget_ms = 0;
+    chrono::steady_clock::time_point start_time;
+    atomic<bool> stop_requested{false};
+    bool aborted = false;
+};
@@ -0,0 +1,208 @@
+#include "SearchScheduler.h"
+
+namespace {
+
+mutex shared_lock;
+unique_ptr<SearchScheduler> shared_scheduler;
+
+}
+
+SearchScheduler::SearchScheduler(int32 worker_count) {
+    if (worker_count <= 0) {
+        worker_count = std::max(1, static_cast<int32>(thread::hardware_concurrency()) - 1);
+    }
+    for (int32 i = 0; i < worker_count; i++) {
+        workers.emplace_back([this]() {
+            work();
+        });
+    }
+}
+
+SearchScheduler::~SearchScheduler() {
+    shutdown();
+}
+
+void SearchScheduler::shutdown() {
+    {
+        lock_guard<mutex> guard(lock);
+        if (is_shutting_down) {
+            return;
+        }
+        is_shutting_down = true;
+        for (auto& [match_id, match] : matches) {
+            drop_jobs(*match);
+            if (match->is_running) {
+                match->search->stop();
+            }
+        }
+    }
+    job_ready.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+SearchScheduler& SearchScheduler::get_shared() {
+    lock_guard<mutex> guard(shared_lock);
+    if (shared_scheduler == nullptr) {
+        shared_scheduler = make_unique<SearchScheduler>();
+    }
+    return *shared_scheduler;
+}
+
+void SearchScheduler::shutdown_shared() {
+    unique_ptr<SearchScheduler> scheduler;
+    {
+        lock_guard<mutex> guard(shared_lock);
+        scheduler = move(shared_scheduler);
+    }
+    // joins the workers outside the lock, a job may still be reaching for get_shared()
+    scheduler.reset();
+}
+
+int32 SearchScheduler::add_match(const MatchSettings& settings) {
+    lock_guard<mutex> guard(lock);
+    auto match = make_unique<Match>();
+    if (!free_searches.empty()) {
+        match->search = move(free_searches.back());
+        free_searches.pop_back();
+    } else {
+        match->search = make_unique<Search>();
+    }
+    match->search->set_time_budget(settings.time_budget_ms);
+    match->search->set_tablebase(settings.tablebase);
+
+    const int32 match_id = next_match_id++;
+    matches[match_id] = move(match);
+    return match_id;
+}
+
+void SearchScheduler::remove_match(int32 match_id) {
+    unique_lock<mutex> guard(lock);
+    auto found = matches.find(match_id);
+    if (found == matches.end()) {
+        return;
+    }
+    Match& match = *found->second;
+    drop_jobs(match);
+    if (match.is_running) {
+        match.search->stop();
+        job_done.wait(guard, [&match]() {
+            return !match.is_running;
+        });
+    }
+
+    // the next match starts from empty tables
+    match.search->clear();
+    match.search->set_tablebase(nullptr);
+    free_searches.push_back(move(match.search));
+    matches.erase(found);
+}
+
+bool SearchScheduler::submit(int32 match_id, Board* position, Task task) {
+    {
+        lock_guard<mutex> guard(lock);
+        auto found = matches.find(match_id);
+        if (found == matches.end() || is_shutting_down) {
+            return false;
+        }
+        Job job;
+        job.task = move(task);
+        job.board = acquire_board();
+        if (position != nullptr) {
+            job.board->copy_pieces_from(*position);
+        }
+        found->second->jobs.push_back(move(job));
+        queued_count++;
+    }
+    job_ready.notify_one();
+    return true;
+}
+
+void SearchScheduler::stop_match(int32 match_id) {
+    lock_guard<mutex> guard(lock);
+    auto found = matches.find(match_id);
+    if (found == matches.end()) {
+        return;
+    }
+    drop_jobs(*found->second);
+    if (found->second->is_running) {
+        found->second->search->stop();
+    }
+}
+
+int32 SearchScheduler::get_queued_count() const {
+    lock_guard<mutex> guard(lock);
+    return queued_count;
+}
+
+void SearchScheduler::work() {
+    unique_lock<mutex> guard(lock);
+    while (!is_shutting_down) {
+        Match* match = pick_match();
+        if (match == nullptr) {
+            job_ready.wait(guard);
+            continue;
+        }
+
+        Job job = move(match->jobs.front());
+        match->jobs.pop_front();
+        queued_count--;
+        match->is_running = true;
+        // reset under the lock, so a stop_match from now on reaches this job
+        match->search->reset_stop();
+
+        guard.unlock();
+        job.task(*match->search, *job.board);
+        guard.lock();
+
+        release_board(move(job.board));
+        match->is_running = false;
+        job_done.notify_all();
+        if (!match->jobs.empty()) {
+            // the match is free again for another worker
+            job_ready.notify_one();
+        }
+    }
+}
+
+SearchScheduler::Match* SearchScheduler::pick_match() {
+    if (queued_count == 0) {
+        return nullptr;
+    }
+    // round robin by match id, starting after the last match served
+    auto first = matches.upper_bound(last_served_id);
+    for (size_t i = 0; i < matches.size(); i++, first++) {
+        if (first == matches.end()) {
+            first = matches.begin();
+        }
+        Match& match = *first->second;
+        if (!match.is_running && !match.jobs.empty()) {
+            last_served_id = first->first;
+            return &match;
+        }
+    }
+    return nullptr;
+}
+
+unique_ptr<Board> SearchScheduler::acquire_board() {
+    if (free_boards.empty()) {
+        return make_unique<Board>();
+    }
+    unique_ptr<Board> board = move(free_boards.back());
+    free_boards.pop_back();
+    return board;
+}
+
+void SearchScheduler::release_board(unique_ptr<Board> board) {
+    free_boards.push_back(move(board));
+}
+
+void SearchScheduler::drop_jobs(Match& match) {
+    for (Job& job : match.jobs) {
+        release_board(move(job.board));
+    }
+    queued_count -= static_cast<int32>(match.jobs.size());
+    match.jobs.clear();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Search.h"
+
+
+// Runs the searches of many concurrent matches on a fixed set of worker
+// threads, so hosting more matches queues more work instead of starting
+// more threads.
+//
+// Each match owns one Search, kept between its jobs so the tables carry
+// over from move to move, and runs its jobs one at a time in the order
+// they were submitted. Free workers serve the matches with pending jobs in
+// turn, so a match with a long queue can't starve the others. The position
+// of a job is copied into a pooled board when it is submitted; boards and
+// searches are reused across jobs and matches, so memory stays bounded by
+// the number of matches and queued jobs.
+class SearchScheduler {
+    public:
+
+    struct MatchSettings {
+        // caps the movetime of every think() of the match, 0 for no cap
+        int64 time_budget_ms = 0;
+        const Tablebase* tablebase = nullptr;
+    };
+
+    // Runs on a worker with the match's search and a private copy of the
+    // submitted position, or an unspecified one when none was given. The
+    // search has been reset_stop()ed already.
+    using Task = function<void(Search& search, Board& board)>;
+
+    // 0 workers uses every core but one, which is left to the game thread
+    explicit SearchScheduler(int32 worker_count = 0);
+    ~SearchScheduler();
+
+    SearchScheduler(const SearchScheduler&) = delete;
+    SearchScheduler& operator=(const SearchScheduler&) = delete;
+
+    // shared by every match of the process, created on first use
+    static SearchScheduler& get_shared();
+
+    // Shuts the shared scheduler down and destroys it, if it was ever created.
+    // The game module calls it on shutdown, before the code the jobs call back
+    // into unloads; a later get_shared() starts a new one.
+    static void shutdown_shared();
+
+    // Drops every queued job, stops the running searches and joins the
+    // workers. Jobs submitted afterwards are refused. Called by the destructor.
+    void shutdown();
+
+    int32 add_match(const MatchSettings& settings);
+
+    // Drops the queued jobs, stops the running one and waits for it. Must
+    // not be called from a task of the same match.
+    void remove_match(int32 match_id);
+
+    // false when the match doesn't exist, position may be nullptr for tasks that don't need one
+    bool submit(int32 match_id, Board* position, Task task);
+
+    // drops the queued jobs and stops the running search, whose task still returns normally
+    void stop_match(int32 match_id);
+
+    int32 get_worker_count() const {
+        return static_cast<int32>(workers.size());
+    }
+
+    // jobs waiting for a worker, over every match
+    int32 get_queued_count() const;
+
+    private:
+
+    struct Job {
+        Task task;
+        unique_ptr<Board> board;
+    };
+
+    struct Match {
+        unique_ptr<Search> search;
+        deque<Job> jobs;
+        bool is_running = false;
+    };
+
+    void work();
+
+    // the first match after the last one served with a job to run, nullptr when there is none
+    Match* pick_match();
+
+    // the pools, called with the lock held
+    unique_ptr<Board> acquire_board();
+    void release_board(unique_ptr<Board> board);
+    void drop_jobs(Match& match);
+
+    mutable mutex lock;
+    condition_variable job_ready;
+    condition_variable job_done;
+
+    map<int32, unique_ptr<Match>> matches;
+    int32 next_match_id = 1;
+    int32 last_served_id = 0;
+    int32 queued_count = 0;
+
+    vector<unique_ptr<Board>> free_boards;
+    vector<unique_ptr<Search>> free_searches;
+
+    vector<thread> workers;
+    bool is_shutting_down = false;
+};
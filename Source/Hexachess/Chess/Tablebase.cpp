@@ -0,0 +1,830 @@
+#include "Tablebase.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+const char tablebase_magic[4] = {'H', 'X', 'T', 'B'};
+
+struct TablebaseHeader {
+    char magic[4];
+    uint32 version;
+    char material[8];
+    uint32 piece_count;
+    uint32 king_classes;
+    uint64 positions_per_side;
+};
+
+static_assert(sizeof(TablebaseHeader) == 32, "the tablebase header is stored as is");
+
+const uint8 draw_value = 0;
+const uint8 unknown_value = 254;
+const uint8 invalid_value = 255;
+// values are stored as plies + 1 below unknown_value
+const int32 max_plies_to_mate = 252;
+
+const int32 cell_count = Board::cell_count;
+
+void set_error(string* error, const string& message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+}
+
+// The moves of every pawnless piece and the symmetries of the board, all
+// on dense cell indices (Chess/HexCoordinates.h).
+struct HexGeometry {
+    static const int32 direction_count = HexCoordinates::direction_count;
+    static const int32 symmetry_count = 12;
+
+    int32 knight_targets[cell_count][12];
+    int32 knight_target_counts[cell_count];
+
+    int32 symmetries[symmetry_count][cell_count];
+    int32 king_classes[cell_count];
+    int32 king_transforms[cell_count];
+    int32 class_cells[cell_count];
+    int32 class_count = 0;
+
+    HexGeometry() {
+        const int32 knight_offsets[12][2] = {
+            {1, 2}, {-1, 3}, {1, -3}, {-1, -2}, {2, 1}, {3, -1},
+            {2, -3}, {3, -2}, {-2, -1}, {-3, 1}, {-2, 3}, {-3, 2}
+        };
+
+        for (int32 index = 0; index < cell_count; index++) {
+            const AxialCoord axial = HexCoordinates::to_axial(index);
+            knight_target_counts[index] = 0;
+            for (const auto& offset : knight_offsets) {
+                int32 target = HexCoordinates::from_axial(axial.q + offset[0], axial.r + offset[1]);
+                if (target != -1) {
+                    knight_targets[index][knight_target_counts[index]++] = target;
+                }
+            }
+
+            // six rotations, then the same on the mirror image
+            for (int32 symmetry = 0; symmetry < symmetry_count; symmetry++) {
+                const AxialCoord mirrored = symmetry >= 6 ? HexCoordinates::mirror(axial) : axial;
+                symmetries[symmetry][index] = HexCoordinates::from_axial(HexCoordinates::rotate(mirrored, symmetry % 6));
+            }
+        }
+
+        // each orbit is represented by its lowest cell
+        for (int32 index = 0; index < cell_count; index++) {
+            int32 representative = index;
+            int32 transform = 0;
+            for (int32 symmetry = 0; symmetry < symmetry_count; symmetry++) {
+                if (symmetries[symmetry][index] < representative) {
+                    representative = symmetries[symmetry][index];
+                    transform = symmetry;
+                }
+            }
+            if (representative == index) {
+                class_cells[class_count] = index;
+                king_classes[index] = class_count++;
+            } else {
+                king_classes[index] = king_classes[representative];
+            }
+            king_transforms[index] = transform;
+        }
+    }
+};
+
+const HexGeometry geometry;
+
+struct PieceSet {
+    int32 count = 0;
+    Cell::PieceType types[Tablebase::max_pieces];
+    // 0 for white, 1 for black
+    int32 colors[Tablebase::max_pieces];
+    int32 cells[Tablebase::max_pieces];
+};
+
+int32 get_piece_rank(char letter) {
+    const char* ranks = "QRBN";
+    const char* rank = strchr(ranks, letter);
+    return rank != nullptr && *rank != '\0' ? static_cast<int32>(rank - ranks) : -1;
+}
+
+// same scale as Board::piece_values
+int32 get_piece_value(char letter) {
+    switch (letter) {
+        case 'Q': return 9;
+        case 'R': return 5;
+        case 'B': return 3;
+        case 'N': return 3;
+        default: return 0;
+    }
+}
+
+char get_piece_letter(Cell::PieceType pt) {
+    switch (pt) {
+        case Cell::PieceType::knight: return 'N';
+        case Cell::PieceType::bishop: return 'B';
+        case Cell::PieceType::rook: return 'R';
+        case Cell::PieceType::queen: return 'Q';
+        case Cell::PieceType::king: return 'K';
+        default: return '?';
+    }
+}
+
+Cell::PieceType get_piece_type(char letter) {
+    switch (letter) {
+        case 'N': return Cell::PieceType::knight;
+        case 'B': return Cell::PieceType::bishop;
+        case 'R': return Cell::PieceType::rook;
+        case 'Q': return Cell::PieceType::queen;
+        case 'K': return Cell::PieceType::king;
+        default: return Cell::PieceType::none;
+    }
+}
+
+// pieces of a normalized material in table order, cells unset
+PieceSet get_material_pieces(const string& material) {
+    PieceSet pieces;
+    int32 color = -1;
+    for (char letter : material) {
+        if (letter == 'K') {
+            color++;
+        }
+        pieces.types[pieces.count] = get_piece_type(letter);
+        pieces.colors[pieces.count] = color;
+        pieces.cells[pieces.count] = -1;
+        pieces.count++;
+    }
+    return pieces;
+}
+
+uint64 get_position_count(int32 piece_count) {
+    uint64 count = 1;
+    for (int32 i = 0; i < piece_count; i++) {
+        count *= cell_count;
+    }
+    return count;
+}
+
+uint64 get_index(const PieceSet& pieces) {
+    uint64 index = 0;
+    for (int32 i = 0; i < pieces.count; i++) {
+        index = index * cell_count + pieces.cells[i];
+    }
+    return index;
+}
+
+void set_cells(PieceSet& pieces, uint64 index) {
+    for (int32 i = pieces.count - 1; i >= 0; i--) {
+        pieces.cells[i] = static_cast<int32>(index % cell_count);
+        index /= cell_count;
+    }
+}
+
+// Reorders a position's pieces into the table order of its material. The
+// material string is returned empty when there is no such table, colors
+// are swapped when black is the stronger side.
+string to_table_order(PieceSet& pieces, bool& is_white_to_move) {
+    int32 king_counts[2] = {0, 0};
+    for (int32 i = 0; i < pieces.count; i++) {
+        if (pieces.types[i] == Cell::PieceType::king) {
+            king_counts[pieces.colors[i]]++;
+        }
+    }
+    if (king_counts[0] != 1 || king_counts[1] != 1) {
+        return "";
+    }
+
+    string sides[2];
+    for (int32 color = 0; color < 2; color++) {
+        sides[color] = "K";
+        for (int32 i = 0; i < pieces.count; i++) {
+            if (pieces.colors[i] == color && pieces.types[i] != Cell::PieceType::king) {
+                sides[color] += get_piece_letter(pieces.types[i]);
+            }
+        }
+    }
+    bool swapped = false;
+    string material = Tablebase::normalize_material(sides[0] + sides[1], &swapped);
+    if (material.empty()) {
+        return material;
+    }
+    if (swapped) {
+        for (int32 i = 0; i < pieces.count; i++) {
+            pieces.colors[i] = 1 - pieces.colors[i];
+        }
+        is_white_to_move = !is_white_to_move;
+    }
+
+    PieceSet ordered = get_material_pieces(material);
+    bool used[Tablebase::max_pieces] = {};
+    for (int32 slot = 0; slot < ordered.count; slot++) {
+        for (int32 i = 0; i < pieces.count; i++) {
+            if (!used[i] && pieces.types[i] == ordered.types[slot] && pieces.colors[i] == ordered.colors[slot]) {
+                ordered.cells[slot] = pieces.cells[i];
+                used[i] = true;
+                break;
+            }
+        }
+    }
+    pieces = ordered;
+    return material;
+}
+
+bool is_slider_direction(Cell::PieceType pt, int32 direction) {
+    switch (pt) {
+        case Cell::PieceType::queen: return true;
+        case Cell::PieceType::rook: return direction < 6;
+        case Cell::PieceType::bishop: return direction >= 6;
+        default: return false;
+    }
+}
+
+// calls visit(target) for every cell the piece on from reaches, stopping slides at occupied cells
+template <typename Visit>
+void for_each_target(Cell::PieceType pt, int32 from, const int32* occupied, Visit visit) {
+    if (pt == Cell::PieceType::knight) {
+        for (int32 i = 0; i < geometry.knight_target_counts[from]; i++) {
+            visit(geometry.knight_targets[from][i]);
+        }
+        return;
+    }
+    for (int32 direction = 0; direction < HexGeometry::direction_count; direction++) {
+        if (pt == Cell::PieceType::king) {
+            int32 target = HexCoordinates::step(from, direction);
+            if (target != -1) {
+                visit(target);
+            }
+            continue;
+        }
+        if (!is_slider_direction(pt, direction)) {
+            continue;
+        }
+        for (int32 target = HexCoordinates::step(from, direction); target != -1; target = HexCoordinates::step(target, direction)) {
+            visit(target);
+            if (occupied[target] != -1) {
+                break;
+            }
+        }
+    }
+}
+
+// occupied holds the piece number on each cell or -1
+void fill_occupied(const PieceSet& pieces, int32* occupied) {
+    std::fill(occupied, occupied + cell_count, -1);
+    for (int32 i = 0; i < pieces.count; i++) {
+        if (pieces.cells[i] != -1) {
+            occupied[pieces.cells[i]] = i;
+        }
+    }
+}
+
+bool is_attacked(const PieceSet& pieces, const int32* occupied, int32 cell, int32 by_color) {
+    for (int32 i = 0; i < pieces.count; i++) {
+        if (pieces.cells[i] == -1 || pieces.colors[i] != by_color) {
+            continue;
+        }
+        bool attacks = false;
+        for_each_target(pieces.types[i], pieces.cells[i], occupied, [&](int32 target) {
+            attacks = attacks || target == cell;
+        });
+        if (attacks) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool is_in_check(const PieceSet& pieces, const int32* occupied, int32 color) {
+    for (int32 i = 0; i < pieces.count; i++) {
+        if (pieces.types[i] == Cell::PieceType::king && pieces.colors[i] == color) {
+            return is_attacked(pieces, occupied, pieces.cells[i], 1 - color);
+        }
+    }
+    return false;
+}
+
+// calls visit(child, captured piece or -1) for every legal move of color
+template <typename Visit>
+void for_each_legal_move(const PieceSet& pieces, int32 color, Visit visit) {
+    int32 occupied[cell_count];
+    fill_occupied(pieces, occupied);
+
+    for (int32 i = 0; i < pieces.count; i++) {
+        if (pieces.cells[i] == -1 || pieces.colors[i] != color) {
+            continue;
+        }
+        for_each_target(pieces.types[i], pieces.cells[i], occupied, [&](int32 target) {
+            int32 captured = occupied[target];
+            if (captured != -1 && pieces.colors[captured] == color) {
+                return;
+            }
+            PieceSet child = pieces;
+            child.cells[i] = target;
+            if (captured != -1) {
+                child.cells[captured] = -1;
+            }
+            int32 child_occupied[cell_count];
+            fill_occupied(child, child_occupied);
+            if (!is_in_check(child, child_occupied, color)) {
+                visit(child, captured);
+            }
+        });
+    }
+}
+
+// Retrograde solver of one material, full index without symmetry reduction
+// so every move has exactly one matching unmove.
+class TablebaseSolver {
+    public:
+
+    TablebaseSolver(const string& in_material, map<string, vector<uint8>>& in_solved, int32 in_thread_count)
+        : material(in_material), solved(in_solved), thread_count(in_thread_count) {
+        pieces = get_material_pieces(material);
+        positions_per_side = get_position_count(pieces.count);
+    }
+
+    bool solve(string* error);
+
+    vector<uint8> take_values() {
+        vector<uint8> result(positions_per_side * 2);
+        for (uint64 entry = 0; entry < result.size(); entry++) {
+            uint8 value = values[entry].load(memory_order_relaxed);
+            result[entry] = value == unknown_value ? draw_value : value;
+        }
+        return result;
+    }
+
+    private:
+
+    struct Push {
+        int32 plies;
+        uint32 entry;
+    };
+
+    static const uint8 has_winning_capture = 0x80;
+
+    template <typename Work>
+    void parallel_for(uint64 count, Work work);
+
+    void init_entry(uint64 entry, vector<Push>& pushes);
+    void propagate(uint64 entry, int32 plies, vector<Push>& pushes);
+    uint8 get_capture_value(PieceSet child, bool is_white_to_move) const;
+
+    string material;
+    map<string, vector<uint8>>& solved;
+    int32 thread_count;
+
+    PieceSet pieces;
+    uint64 positions_per_side = 0;
+
+    unique_ptr<atomic<uint8>[]> values;
+    // non-final moves left, has_winning_capture when a capture already wins
+    unique_ptr<atomic<uint8>[]> counters;
+    // plies of the best winning capture, or of the longest capture that loses
+    unique_ptr<uint8[]> capture_plies;
+
+    vector<vector<uint32>> buckets;
+    bool too_long = false;
+};
+
+template <typename Work>
+void TablebaseSolver::parallel_for(uint64 count, Work work) {
+    vector<vector<Push>> pushes(thread_count);
+    vector<thread> threads;
+    for (int32 worker = 0; worker < thread_count; worker++) {
+        uint64 begin = count * worker / thread_count;
+        uint64 end = count * (worker + 1) / thread_count;
+        threads.emplace_back([&, worker, begin, end]() {
+            for (uint64 i = begin; i < end; i++) {
+                work(i, pushes[worker]);
+            }
+        });
+    }
+    for (thread& worker_thread : threads) {
+        worker_thread.join();
+    }
+
+    for (const vector<Push>& worker_pushes : pushes) {
+        for (const Push& push : worker_pushes) {
+            if (push.plies > max_plies_to_mate) {
+                too_long = true;
+                continue;
+            }
+            buckets[push.plies].push_back(push.entry);
+        }
+    }
+}
+
+uint8 TablebaseSolver::get_capture_value(PieceSet child, bool is_white_to_move) const {
+    // drop the captured piece
+    PieceSet remaining;
+    for (int32 i = 0; i < child.count; i++) {
+        if (child.cells[i] != -1) {
+            remaining.types[remaining.count] = child.types[i];
+            remaining.colors[remaining.count] = child.colors[i];
+            remaining.cells[remaining.count] = child.cells[i];
+            remaining.count++;
+        }
+    }
+    if (remaining.count == 2) {
+        return draw_value;
+    }
+    string child_material = to_table_order(remaining, is_white_to_move);
+    const vector<uint8>& child_values = solved.at(child_material);
+    return child_values[(is_white_to_move ? 0 : get_position_count(remaining.count)) + get_index(remaining)];
+}
+
+void TablebaseSolver::init_entry(uint64 entry, vector<Push>& pushes) {
+    const int32 color = entry < positions_per_side ? 0 : 1;
+    PieceSet position = pieces;
+    set_cells(position, entry % positions_per_side);
+
+    int32 occupied[cell_count];
+    std::fill(occupied, occupied + cell_count, -1);
+    for (int32 i = 0; i < position.count; i++) {
+        if (occupied[position.cells[i]] != -1) {
+            values[entry] = invalid_value;
+            return;
+        }
+        occupied[position.cells[i]] = i;
+    }
+    // the side that just moved can't be left in check
+    if (is_in_check(position, occupied, 1 - color)) {
+        values[entry] = invalid_value;
+        return;
+    }
+
+    int32 move_count = 0;
+    int32 open_moves = 0;
+    int32 best_win = -1;
+    int32 longest_loss = 0;
+    for_each_legal_move(position, color, [&](const PieceSet& child, int32 captured) {
+        move_count++;
+        if (captured == -1) {
+            open_moves++;
+            return;
+        }
+        uint8 value = get_capture_value(child, color == 1);
+        if (value == draw_value) {
+            open_moves++;
+            return;
+        }
+        int32 plies = value - 1;
+        if (plies % 2 == 0) {
+            best_win = best_win == -1 ? plies + 1 : std::min(best_win, plies + 1);
+        } else {
+            longest_loss = std::max(longest_loss, plies);
+        }
+    });
+
+    if (move_count == 0) {
+        if (is_in_check(position, occupied, color)) {
+            values[entry] = 1;
+            pushes.push_back(Push{0, static_cast<uint32>(entry)});
+        } else {
+            values[entry] = draw_value;
+        }
+        return;
+    }
+
+    if (best_win != -1) {
+        counters[entry] = static_cast<uint8>(open_moves) | has_winning_capture;
+        capture_plies[entry] = static_cast<uint8>(std::min(best_win, max_plies_to_mate + 1));
+        pushes.push_back(Push{best_win, static_cast<uint32>(entry)});
+    } else if (open_moves == 0) {
+        values[entry] = static_cast<uint8>(std::min(longest_loss + 2, static_cast<int32>(unknown_value) - 1));
+        pushes.push_back(Push{longest_loss + 1, static_cast<uint32>(entry)});
+    } else {
+        counters[entry] = static_cast<uint8>(open_moves);
+        capture_plies[entry] = static_cast<uint8>(longest_loss);
+    }
+}
+
+void TablebaseSolver::propagate(uint64 entry, int32 plies, vector<Push>& pushes) {
+    uint8 value = values[entry].load(memory_order_relaxed);
+    if (value == unknown_value) {
+        // a winning capture found in init_entry, unless a shorter win came first
+        if (!values[entry].compare_exchange_strong(value, static_cast<uint8>(plies + 1))) {
+            return;
+        }
+        value = static_cast<uint8>(plies + 1);
+    }
+    if (value != plies + 1) {
+        return;
+    }
+
+    // undo a move of the side that just moved, captures can't be undone
+    const int32 color = entry < positions_per_side ? 0 : 1;
+    const int32 mover = 1 - color;
+    PieceSet position = pieces;
+    set_cells(position, entry % positions_per_side);
+    int32 occupied[cell_count];
+    fill_occupied(position, occupied);
+
+    for (int32 i = 0; i < position.count; i++) {
+        if (position.colors[i] != mover) {
+            continue;
+        }
+        const int32 from = position.cells[i];
+        for_each_target(position.types[i], from, occupied, [&](int32 target) {
+            if (occupied[target] != -1) {
+                return;
+            }
+            position.cells[i] = target;
+            uint64 parent = (mover == 0 ? 0 : positions_per_side) + get_index(position);
+            position.cells[i] = from;
+
+            uint8 parent_value = values[parent].load(memory_order_relaxed);
+            if (parent_value != unknown_value) {
+                return;
+            }
+            if (plies % 2 == 0) {
+                // the parent mates by moving here
+                if (plies + 1 > max_plies_to_mate) {
+                    pushes.push_back(Push{plies + 1, static_cast<uint32>(parent)});
+                    return;
+                }
+                if (values[parent].compare_exchange_strong(parent_value, static_cast<uint8>(plies + 2))) {
+                    uint8 counter = counters[parent].load(memory_order_relaxed);
+                    // already queued with the same distance by its capture
+                    if (!((counter & has_winning_capture) && capture_plies[parent] == plies + 1)) {
+                        pushes.push_back(Push{plies + 1, static_cast<uint32>(parent)});
+                    }
+                }
+                return;
+            }
+            uint8 previous = counters[parent].fetch_sub(1);
+            if (previous == 1) {
+                // every move of the parent loses, it takes the longest
+                int32 loss = std::max(plies, static_cast<int32>(capture_plies[parent])) + 1;
+                uint8 expected = unknown_value;
+                if (values[parent].compare_exchange_strong(expected, static_cast<uint8>(std::min(loss + 1, static_cast<int32>(unknown_value) - 1)))) {
+                    pushes.push_back(Push{loss, static_cast<uint32>(parent)});
+                }
+            }
+        });
+    }
+}
+
+bool TablebaseSolver::solve(string* error) {
+    const uint64 entry_count = positions_per_side * 2;
+    values.reset(new atomic<uint8>[entry_count]);
+    counters.reset(new atomic<uint8>[entry_count]);
+    capture_plies.reset(new uint8[entry_count]);
+    for (uint64 entry = 0; entry < entry_count; entry++) {
+        values[entry].store(unknown_value, memory_order_relaxed);
+        counters[entry].store(0, memory_order_relaxed);
+        capture_plies[entry] = 0;
+    }
+    buckets.assign(max_plies_to_mate + 1, vector<uint32>());
+
+    parallel_for(entry_count, [this](uint64 entry, vector<Push>& pushes) {
+        init_entry(entry, pushes);
+    });
+
+    for (int32 plies = 0; plies <= max_plies_to_mate; plies++) {
+        vector<uint32> bucket = move(buckets[plies]);
+        parallel_for(bucket.size(), [this, &bucket, plies](uint64 i, vector<Push>& pushes) {
+            propagate(bucket[i], plies, pushes);
+        });
+    }
+
+    if (too_long) {
+        set_error(error, material + " has mates longer than " + to_string(max_plies_to_mate) + " plies");
+        return false;
+    }
+    return true;
+}
+
+// solves the material and everything it captures into, smallest first
+bool solve_material(const string& material, map<string, vector<uint8>>& solved, int32 thread_count, string* error) {
+    if (solved.count(material) != 0) {
+        return true;
+    }
+
+    PieceSet pieces = get_material_pieces(material);
+    for (int32 i = 0; i < pieces.count; i++) {
+        if (pieces.types[i] == Cell::PieceType::king) {
+            continue;
+        }
+        string sides[2] = {"", ""};
+        for (int32 j = 0; j < pieces.count; j++) {
+            if (j != i) {
+                sides[pieces.colors[j]] += get_piece_letter(pieces.types[j]);
+            }
+        }
+        string child_material = Tablebase::normalize_material(sides[0] + sides[1]);
+        if (child_material != "KK" && !solve_material(child_material, solved, thread_count, error)) {
+            return false;
+        }
+    }
+
+    TablebaseSolver solver(material, solved, thread_count);
+    if (!solver.solve(error)) {
+        return false;
+    }
+    solved[material] = solver.take_values();
+    return true;
+}
+
+}
+
+const vector<string>& Tablebase::get_standard_materials() {
+    static const vector<string> materials = {
+        "KQK", "KRK", "KBK", "KNK",
+        "KQQK", "KQRK", "KQBK", "KQNK", "KRRK", "KRBK", "KRNK", "KBBK", "KBNK", "KNNK",
+        "KQKQ", "KQKR", "KQKB", "KQKN", "KRKR", "KRKB", "KRKN", "KBKB", "KBKN", "KNKN"
+    };
+    return materials;
+}
+
+string Tablebase::normalize_material(const string& material, bool* swapped) {
+    if (material.empty() || material[0] != 'K') {
+        return "";
+    }
+    size_t black_king = material.find('K', 1);
+    if (black_king == string::npos || material.find('K', black_king + 1) != string::npos || material.size() > max_pieces) {
+        return "";
+    }
+
+    string sides[2] = {material.substr(1, black_king - 1), material.substr(black_king + 1)};
+    int32 strengths[2] = {0, 0};
+    for (int32 color = 0; color < 2; color++) {
+        for (char letter : sides[color]) {
+            if (get_piece_rank(letter) == -1) {
+                return "";
+            }
+            strengths[color] += get_piece_value(letter);
+        }
+        sort(sides[color].begin(), sides[color].end(), [](char a, char b) {
+            return get_piece_rank(a) < get_piece_rank(b);
+        });
+    }
+
+    // more material first, then the stronger pieces
+    bool is_black_stronger = strengths[1] > strengths[0];
+    if (strengths[0] == strengths[1]) {
+        is_black_stronger = lexicographical_compare(sides[1].begin(), sides[1].end(), sides[0].begin(), sides[0].end(), [](char a, char b) {
+            return get_piece_rank(a) < get_piece_rank(b);
+        });
+    }
+    if (swapped != nullptr) {
+        *swapped = is_black_stronger;
+    }
+    return is_black_stronger ? "K" + sides[1] + "K" + sides[0] : "K" + sides[0] + "K" + sides[1];
+}
+
+string Tablebase::get_file_name(const string& material) {
+    return material + ".hxtb";
+}
+
+int32 Tablebase::open_directory(const string& directory) {
+    int32 opened = 0;
+    for (const string& material : get_standard_materials()) {
+        if (open(directory + "/" + get_file_name(material))) {
+            opened++;
+        }
+    }
+    return opened;
+}
+
+bool Tablebase::open(const string& path, string* error) {
+    unique_ptr<Table> table = make_unique<Table>();
+    if (!table->file.open(path, error)) {
+        return false;
+    }
+
+    const TablebaseHeader* header = reinterpret_cast<const TablebaseHeader*>(table->file.get_data());
+    if (table->file.get_size() < sizeof(TablebaseHeader) || memcmp(header->magic, tablebase_magic, sizeof(tablebase_magic)) != 0) {
+        set_error(error, path + " is not a tablebase");
+        return false;
+    }
+    if (header->version != version) {
+        set_error(error, path + " has tablebase version " + to_string(header->version) + ", expected " + to_string(version));
+        return false;
+    }
+
+    string material(header->material, strnlen(header->material, sizeof(header->material)));
+    if (normalize_material(material) != material || static_cast<int32>(header->piece_count) != static_cast<int32>(material.size())) {
+        set_error(error, path + " has unknown material " + material);
+        return false;
+    }
+    const uint64 positions_per_side = static_cast<uint64>(geometry.class_count) * get_position_count(header->piece_count - 1);
+    if (header->king_classes != static_cast<uint32>(geometry.class_count) || header->positions_per_side != positions_per_side
+        || table->file.get_size() != sizeof(TablebaseHeader) + positions_per_side * 2) {
+        set_error(error, path + " is truncated");
+        return false;
+    }
+
+    table->values = table->file.get_data() + sizeof(TablebaseHeader);
+    table->piece_count = header->piece_count;
+    table->positions_per_side = positions_per_side;
+    tables[material] = move(table);
+    return true;
+}
+
+void Tablebase::close() {
+    tables.clear();
+}
+
+bool Tablebase::probe(map<int32, Cell*>& in_board, bool is_white_to_move, TablebaseResult& result) const {
+    if (tables.empty()) {
+        return false;
+    }
+
+    PieceSet pieces;
+    for (const auto& [key, cell] : in_board) {
+        if (!cell->has_piece()) {
+            continue;
+        }
+        if (pieces.count == max_pieces || cell->get_piece_type() == Cell::PieceType::pawn) {
+            return false;
+        }
+        pieces.types[pieces.count] = cell->get_piece_type();
+        pieces.colors[pieces.count] = cell->get_piece_color() == Cell::PieceColor::white ? 0 : 1;
+        pieces.cells[pieces.count] = Board::to_cell_index(key);
+        pieces.count++;
+    }
+    if (pieces.count == 2) {
+        result = TablebaseResult();
+        return true;
+    }
+
+    string material = to_table_order(pieces, is_white_to_move);
+    auto table = tables.find(material);
+    if (table == tables.end()) {
+        return false;
+    }
+
+    // move the white king onto one of the stored cells
+    const int32 symmetry = geometry.king_transforms[pieces.cells[0]];
+    uint64 index = geometry.king_classes[pieces.cells[0]];
+    for (int32 i = 1; i < pieces.count; i++) {
+        index = index * cell_count + geometry.symmetries[symmetry][pieces.cells[i]];
+    }
+    uint8 value = table->second->values[(is_white_to_move ? 0 : table->second->positions_per_side) + index];
+    if (value == invalid_value) {
+        return false;
+    }
+
+    result = TablebaseResult();
+    if (value != draw_value) {
+        result.plies_to_mate = value - 1;
+        result.outcome = result.plies_to_mate % 2 == 0 ? TablebaseResult::loss : TablebaseResult::win;
+    }
+    return true;
+}
+
+bool generate_tablebase(const string& material, const string& directory, int32 thread_count, string* error) {
+    string normalized = Tablebase::normalize_material(material);
+    if (normalized.empty() || normalized.size() < 3) {
+        set_error(error, "unsupported material " + material);
+        return false;
+    }
+    if (thread_count <= 0) {
+        thread_count = std::max(1, static_cast<int32>(thread::hardware_concurrency()));
+    }
+
+    map<string, vector<uint8>> solved;
+    if (!solve_material(normalized, solved, thread_count, error)) {
+        return false;
+    }
+    const vector<uint8>& values = solved[normalized];
+
+    // keep only the canonical white king cells
+    const int32 piece_count = static_cast<int32>(normalized.size());
+    const uint64 full_positions_per_side = get_position_count(piece_count);
+    const uint64 other_positions = get_position_count(piece_count - 1);
+    vector<uint8> reduced;
+    reduced.reserve(static_cast<size_t>(geometry.class_count * other_positions * 2));
+    for (int32 color = 0; color < 2; color++) {
+        for (int32 king_class = 0; king_class < geometry.class_count; king_class++) {
+            const uint64 first = color * full_positions_per_side + geometry.class_cells[king_class] * other_positions;
+            reduced.insert(reduced.end(), values.begin() + first, values.begin() + first + other_positions);
+        }
+    }
+
+    TablebaseHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, tablebase_magic, sizeof(tablebase_magic));
+    header.version = Tablebase::version;
+    memcpy(header.material, normalized.data(), normalized.size());
+    header.piece_count = piece_count;
+    header.king_classes = geometry.class_count;
+    header.positions_per_side = geometry.class_count * other_positions;
+
+    const string path = directory + "/" + Tablebase::get_file_name(normalized);
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        set_error(error, "can't write " + path);
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    written = written && fwrite(reduced.data(), 1, reduced.size(), file) == reduced.size();
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        set_error(error, "can't write " + path);
+    }
+    return written;
+}
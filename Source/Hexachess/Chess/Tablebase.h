@@ -0,0 +1,87 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChessEngine.h"
+#include "MappedFile.h"
+
+
+// Endgame tablebases for pawnless endings of up to four pieces, kings
+// included. Each ending ("material", e.g. KQK or KRKN, white pieces first)
+// has its own file holding the distance to mate of every position:
+//
+//   header   "HXTB", uint32 version, char material[8], uint32 piece count,
+//            uint32 king classes, uint64 positions per side
+//   values   uint8 [side to move][white king class][cell of each other piece]
+//
+// The board has the symmetry of the hexagon (six rotations and their
+// mirror images), so only the 12 white king cells that no symmetry maps
+// onto each other are stored. A value is 0 for a draw, 255 for a position
+// that can't arise, and otherwise 1 + the number of plies to mate: even
+// plies mean the side to move gets mated, odd plies mean it mates.
+//
+// Stalemate is scored as a draw.
+
+struct TablebaseResult {
+    enum Outcome {
+        loss,
+        draw,
+        win
+    };
+
+    // from the point of view of the side to move
+    Outcome outcome = draw;
+    int32 plies_to_mate = 0;
+};
+
+class Tablebase {
+    public:
+
+    static const uint32 version = 1;
+    static const int32 max_pieces = 4;
+
+    // every ending hexengine-tb generates by default
+    static const vector<string>& get_standard_materials();
+
+    // Puts the pieces in tablebase order: the stronger side first, each
+    // side's pieces by decreasing value. Empty for unsupported material.
+    // swapped is set when black is the stronger side.
+    static string normalize_material(const string& material, bool* swapped = nullptr);
+
+    static string get_file_name(const string& material);
+
+    // opens every standard ending found in the directory, returns how many
+    int32 open_directory(const string& directory);
+    bool open(const string& path, string* error = nullptr);
+    void close();
+
+    bool is_open() const {
+        return !tables.empty();
+    }
+
+    // false when the position is not covered by an open table
+    bool probe(map<int32, Cell*>& in_board, bool is_white_to_move, TablebaseResult& result) const;
+
+    bool probe(Board& board, bool is_white_to_move, TablebaseResult& result) const {
+        return probe(board.board_map, is_white_to_move, result);
+    }
+
+    private:
+
+    struct Table {
+        MappedFile file;
+        const uint8* values = nullptr;
+        int32 piece_count = 0;
+        uint64 positions_per_side = 0;
+    };
+
+    map<string, unique_ptr<Table>> tables;
+};
+
+// Retrograde analysis of one ending, with every smaller ending it can
+// reach by a capture solved first in memory. thread_count 0 uses every
+// core. The table is written to directory/Tablebase::get_file_name().
+bool generate_tablebase(const string& material, const string& directory, int32 thread_count, string* error = nullptr);
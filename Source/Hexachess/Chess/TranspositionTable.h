@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "EngineTypes.h"
+
+
+struct TranspositionEntry {
+    enum Bound : uint8 {
+        none, exact, lower, upper
+    };
+
+    uint64 key = 0;
+    int32 score = 0;
+    // best move as packed by Board::pack_move, 0 when there is none
+    uint16 move = 0;
+    int16 depth = -1;
+    Bound bound = Bound::none;
+    uint8 generation = 0;
+};
+
+// Fixed size hash table keyed by Board::get_hash. Entries of the current
+// generation are only replaced by results at least as deep; entries left
+// from earlier generations are always replaced.
+class TranspositionTable {
+    public:
+
+    explicit TranspositionTable(uint32 size_log2 = 16) {
+        resize(size_log2);
+    }
+
+    void resize(uint32 size_log2) {
+        entries.assign(size_t(1) << size_log2, TranspositionEntry());
+        mask = (uint64(1) << size_log2) - 1;
+    }
+
+    void clear() {
+        std::fill(entries.begin(), entries.end(), TranspositionEntry());
+        generation = 0;
+    }
+
+    // called between searches so older results make room for new ones
+    void new_generation() {
+        generation++;
+    }
+
+    const TranspositionEntry* probe(uint64 key) const {
+        const TranspositionEntry& entry = entries[key & mask];
+        return entry.bound != TranspositionEntry::Bound::none && entry.key == key ? &entry : nullptr;
+    }
+
+    void store(uint64 key, int32 depth, int32 score, TranspositionEntry::Bound bound, uint16 move) {
+        TranspositionEntry& entry = entries[key & mask];
+        if (entry.bound != TranspositionEntry::Bound::none && entry.generation == generation && entry.depth > depth) {
+            return;
+        }
+        entry.key = key;
+        entry.score = score;
+        entry.move = move;
+        entry.depth = static_cast<int16>(depth);
+        entry.bound = bound;
+        entry.generation = generation;
+    }
+
+    private:
+
+    std::vector<TranspositionEntry> entries;
+    uint64 mask = 0;
+    uint8 generation = 0;
+};
@@ -1 +1,214 @@
 #include "HexaGameState.h"
+
+#include "GameFramework/PlayerState.h"
+#include "Net/UnrealNetwork.h"
+
+#include "Actors/ChessGod.h"
+#include "Network/HexMoveSender.h"
+
+
+void AHexaGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AHexaGameState, MatchNumber);
+	DOREPLIFETIME(AHexaGameState, Moves);
+	DOREPLIFETIME(AHexaGameState, WhitePlayer);
+	DOREPLIFETIME(AHexaGameState, BlackPlayer);
+}
+
+void AHexaGameState::AddPlayerState(APlayerState* PlayerState)
+{
+	Super::AddPlayerState(PlayerState);
+
+	if (!HasAuthority() || PlayerState == nullptr || PlayerState->IsInactive())
+	{
+		return;
+	}
+	if (WhitePlayer == nullptr)
+	{
+		WhitePlayer = PlayerState;
+	}
+	else if (BlackPlayer == nullptr && WhitePlayer != PlayerState)
+	{
+		BlackPlayer = PlayerState;
+	}
+}
+
+void AHexaGameState::RemovePlayerState(APlayerState* PlayerState)
+{
+	if (HasAuthority())
+	{
+		if (WhitePlayer == PlayerState)
+		{
+			WhitePlayer = nullptr;
+		}
+		if (BlackPlayer == PlayerState)
+		{
+			BlackPlayer = nullptr;
+		}
+	}
+
+	Super::RemovePlayerState(PlayerState);
+}
+
+bool AHexaGameState::GetPlayerSide(const APlayerState* Player, bool& IsWhitePlayer) const
+{
+	if (Player == nullptr || (Player != WhitePlayer && Player != BlackPlayer))
+	{
+		return false;
+	}
+	IsWhitePlayer = Player == WhitePlayer;
+	return true;
+}
+
+bool AHexaGameState::SubmitMove(FIntPoint From, FIntPoint To, EPieceType Promotion)
+{
+	if (!HasAuthority() || ChessGod == nullptr)
+	{
+		return false;
+	}
+	return SubmitPackedMove(nullptr, ChessGod->PackMove(From, To, Promotion), AppliedMoveCount + 1);
+}
+
+bool AHexaGameState::SubmitPackedMove(const APlayerState* Player, uint16 PackedMove, int32 Sequence)
+{
+	bool bIsWhitePlayer = false;
+	if (Player != nullptr && (!GetPlayerSide(Player, bIsWhitePlayer) || bIsWhitePlayer != IsWhiteToMove()))
+	{
+		return false;
+	}
+
+	// a stale sequence is a move sent twice or after the other side already moved
+	if (!HasAuthority() || ChessGod == nullptr || Sequence != AppliedMoveCount + 1 || !ApplyMove(PackedMove))
+	{
+		return false;
+	}
+
+	FReplicatedMove& Entry = Moves.AddDefaulted_GetRef();
+	Entry.PackedMove = PackedMove;
+	Entry.Sequence = static_cast<uint16>(AppliedMoveCount);
+	Entry.PositionCheck = FReplicatedMove::ToPositionCheck(ChessGod->GetPositionHash());
+	return true;
+}
+
+void AHexaGameState::RestartGame()
+{
+	if (HasAuthority())
+	{
+		MatchNumber++;
+		Moves.Empty();
+	}
+	ResetLocalMatch();
+}
+
+bool AHexaGameState::IsWhiteToMove() const
+{
+	return ChessGod != nullptr ? ChessGod->IsWhiteToMove() : true;
+}
+
+FString AHexaGameState::GetResyncNotation() const
+{
+	return ChessGod != nullptr ? ChessGod->GetNotation() : FString();
+}
+
+void AHexaGameState::ApplyResync(const FString& Notation, int32 MoveCount, int32 ForMatchNumber)
+{
+	if (HasAuthority() || ChessGod == nullptr || ForMatchNumber != MatchNumber)
+	{
+		return;
+	}
+
+	bool bIsWhiteToMove = true;
+	const TArray<FBoardSetupConflict> Conflicts = ChessGod->SetupFromNotation(Notation, bIsWhiteToMove);
+	if (Conflicts.Num() > 0)
+	{
+		// asking again would only get the same position, so leave it to whoever listens
+		UE_LOG(LogTemp, Error, TEXT("ApplyResync: can't set up the server's position \"%s\": %s"), *Notation, *Conflicts[0].Message);
+		OnDesyncDetected.Broadcast(MoveCount);
+		return;
+	}
+	AppliedMoveCount = MoveCount;
+	bIsDesynced = false;
+	OnResynced.Broadcast(AppliedMoveCount);
+
+	// the moves replicated while the position was on its way
+	ApplyPendingMoves();
+}
+
+void AHexaGameState::OnRep_MatchNumber()
+{
+	if (AppliedMatchNumber != MatchNumber)
+	{
+		ResetLocalMatch();
+	}
+}
+
+void AHexaGameState::OnRep_Moves()
+{
+	// the moves of a new match may arrive before its number
+	if (AppliedMatchNumber != MatchNumber)
+	{
+		ResetLocalMatch();
+	}
+	ApplyPendingMoves();
+}
+
+void AHexaGameState::ApplyPendingMoves()
+{
+	for (int32 Index = AppliedMoveCount; Index < Moves.Num() && !bIsDesynced; Index++)
+	{
+		const FReplicatedMove& Entry = Moves[Index];
+		if (Entry.Sequence != static_cast<uint16>(Index + 1) || !ApplyMove(Entry.PackedMove)
+			|| Entry.PositionCheck != FReplicatedMove::ToPositionCheck(ChessGod->GetPositionHash()))
+		{
+			ReportDesync(Index + 1);
+		}
+	}
+}
+
+bool AHexaGameState::ApplyMove(uint16 PackedMove)
+{
+	if (ChessGod == nullptr)
+	{
+		return false;
+	}
+
+	FIntPoint From;
+	FIntPoint To;
+	EPieceType Promotion;
+	if (!ChessGod->UnpackMove(PackedMove, From, To, Promotion) || !ChessGod->IsLegalMove(IsWhiteToMove(), From, To, Promotion))
+	{
+		return false;
+	}
+
+	ChessGod->MovePiece(From, To, Promotion);
+	AppliedMoveCount++;
+	OnMoveReplicated.Broadcast(From, To, Promotion, AppliedMoveCount);
+	return true;
+}
+
+void AHexaGameState::ResetLocalMatch()
+{
+	AppliedMatchNumber = MatchNumber;
+	AppliedMoveCount = 0;
+	bIsDesynced = false;
+	if (ChessGod != nullptr)
+	{
+		ChessGod->StartGame();
+	}
+}
+
+void AHexaGameState::ReportDesync(int32 Sequence)
+{
+	bIsDesynced = true;
+	OnDesyncDetected.Broadcast(Sequence);
+
+	// moves stop being played here until the server's position arrives
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	UHexMoveSenderComponent* Sender = PlayerController != nullptr ? PlayerController->FindComponentByClass<UHexMoveSenderComponent>() : nullptr;
+	if (Sender != nullptr)
+	{
+		Sender->RequestResync();
+	}
+}
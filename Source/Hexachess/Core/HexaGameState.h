@@ -3,11 +3,22 @@
 #include "CoreMinimal.h"
 #include "GameFramework/GameStateBase.h"
 
+#include "Types/PieceType.h"
+#include "Types/ReplicatedMove.h"
+
 #include "HexaGameState.generated.h"
 
+class AChessGod;
+class APlayerState;
+
 
 /**
- * 
+ * Runs a networked match in lockstep. The server validates and plays each
+ * move on its ChessGod and appends it to Moves with its sequence number and
+ * a check of the resulting position; every client plays the same moves on
+ * its own ChessGod and compares both after each one. A client that drifts
+ * apart asks the server for the position in the engine notation and carries
+ * on from there instead of dropping the match.
  */
 UCLASS()
 class HEXACHESS_API AHexaGameState : public AGameStateBase
@@ -16,14 +27,118 @@ class HEXACHESS_API AHexaGameState : public AGameStateBase
 
 public:
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void AddPlayerState(APlayerState* PlayerState) override;
+	virtual void RemovePlayerState(APlayerState* PlayerState) override;
+
+	// the engine every move is played on, set on the server and on every client
+	UPROPERTY(BlueprintReadWrite, Category = "Network")
+	AChessGod* ChessGod = nullptr;
+
+	/*
+	 * Server only: plays the move if it is legal and the side's turn, then replicates it.
+	 * Clients submit through UHexMoveSenderComponent on their player controller.
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool SubmitMove(FIntPoint From, FIntPoint To, EPieceType Promotion);
+
+	/*
+	 * Server side of SubmitMove for a packed move, Sequence is the one the sender expects it to get.
+	 * A move sent by a player is only played when that player owns the side to move,
+	 * Player is nullptr for moves made on the server itself.
+	 */
+	bool SubmitPackedMove(const APlayerState* Player, uint16 PackedMove, int32 Sequence);
+
+	// the side the player plays, false for a spectator. The first player to join plays white, the second black
+	UFUNCTION(BlueprintPure)
+	bool GetPlayerSide(const APlayerState* Player, bool& IsWhitePlayer) const;
+
+	// moves played so far, the next move gets this plus one as its sequence
+	UFUNCTION(BlueprintPure)
+	int32 GetMoveCount() const { return AppliedMoveCount; }
+
+	// taken from ChessGod, a resynced position may have either side to move whatever the move count
+	UFUNCTION(BlueprintPure)
+	bool IsWhiteToMove() const;
+
+	UFUNCTION(BlueprintPure)
+	bool IsDesynced() const { return bIsDesynced; }
+
+	// the current match, counted up by every RestartGame
+	int32 GetMatchNumber() const { return MatchNumber; }
+
+	// the position a desynced client restarts from, in the engine notation
+	FString GetResyncNotation() const;
+
+	// client side of a resync, ignored when the server restarted the match since.
+	// A position that can't be set up leaves the client desynced and reports it through OnDesyncDetected
+	void ApplyResync(const FString& Notation, int32 MoveCount, int32 ForMatchNumber);
+
+	// called on every machine once a move is played on its ChessGod, to update the visuals
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnMoveReplicated, FIntPoint, From, FIntPoint, To, EPieceType, Promotion, int32, Sequence);
+
+	UPROPERTY(BlueprintAssignable)
+	FOnMoveReplicated OnMoveReplicated;
+
+	// called on a client whose position no longer matches the server's after the move with this sequence
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDesyncDetected, int32, Sequence);
+
+	UPROPERTY(BlueprintAssignable)
+	FOnDesyncDetected OnDesyncDetected;
+
+	// called once a desynced client has the server's position, the pieces on screen need rebuilding from ChessGod
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnResynced, int32, Sequence);
+
+	UPROPERTY(BlueprintAssignable)
+	FOnResynced OnResynced;
+
 	// session boilerplate for later
 
+	// on the server, starts the match over on every machine
 	UFUNCTION(BlueprintCallable)
-	virtual void RestartGame() {}
+	virtual void RestartGame();
 
 	UFUNCTION(BlueprintCallable)
 	virtual void PauseGame() {}
 
 	UFUNCTION(BlueprintCallable)
 	virtual void ResumeGame() {}
+
+protected:
+
+	UPROPERTY(ReplicatedUsing = OnRep_MatchNumber)
+	int32 MatchNumber = 0;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Moves)
+	TArray<FReplicatedMove> Moves;
+
+	// seated by the server as players join, a seat frees up when its player leaves
+	UPROPERTY(Replicated)
+	APlayerState* WhitePlayer = nullptr;
+
+	UPROPERTY(Replicated)
+	APlayerState* BlackPlayer = nullptr;
+
+	UFUNCTION()
+	void OnRep_MatchNumber();
+
+	UFUNCTION()
+	void OnRep_Moves();
+
+private:
+
+	// plays a packed move on ChessGod, false when it isn't a legal move of the side to move
+	bool ApplyMove(uint16 PackedMove);
+
+	// plays the replicated moves not played here yet, stopping at the first one that disagrees
+	void ApplyPendingMoves();
+
+	// starts the match over on this machine only
+	void ResetLocalMatch();
+
+	void ReportDesync(int32 Sequence);
+
+	int32 AppliedMoveCount = 0;
+	int32 AppliedMatchNumber = 0;
+	bool bIsDesynced = false;
 };
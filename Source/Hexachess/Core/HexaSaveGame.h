@@ -0,0 +1,52 @@
+#pragma once
+
+#include <GameFramework/SaveGame.h>
+
+#include "Types/AIType.h"
+
+#include "HexaSaveGame.generated.h"
+
+
+/*
+ * An unfinished match as saved by AChessGod::SaveMatch. The position is
+ * stored as a snapshot in the engine notation, so loading doesn't replay
+ * the game; the moves come along as a replay (Chess/Replay.h) and the
+ * position hashes only since the last capture or pawn move, which is all
+ * the draw rules need.
+ */
+UCLASS()
+class HEXACHESS_API UHexaSaveGame : public USaveGame
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY()
+    FString Notation;
+
+    UPROPERTY()
+    TArray<uint64> RecentHashes;
+
+    UPROPERTY()
+    TArray<uint8> Replay;
+
+    // AI settings
+
+    UPROPERTY()
+    bool IsPlayingAgainstAI = false;
+
+    UPROPERTY()
+    EAIType AIType = EAIType::Random;
+
+    UPROPERTY()
+    EAIDifficulty AIDifficulty = EAIDifficulty::Easy;
+
+    UPROPERTY()
+    bool IsAIPlayingWhite = false;
+
+    UPROPERTY()
+    bool bPonder = true;
+
+    UPROPERTY()
+    bool bUseOpeningBook = true;
+};
@@ -3,4 +3,18 @@
 #include "Hexachess.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Hexachess, "Hexachess" );
+#include "Chess/SearchScheduler.h"
+
+
+class FHexachessModule : public FDefaultGameModuleImpl
+{
+public:
+
+	virtual void ShutdownModule() override
+	{
+		// the search workers run module code, so they are joined before it unloads
+		SearchScheduler::shutdown_shared();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FHexachessModule, Hexachess, "Hexachess" );
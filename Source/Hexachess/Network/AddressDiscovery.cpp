@@ -0,0 +1,66 @@
+#include "AddressDiscovery.h"
+
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "HttpModule.h"
+#include "Http.h"
+#include "Serialization/JsonSerializer.h"
+
+
+void FLocalAddressDiscovery::Discover(FOnDiscovered OnDiscovered)
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	TArray<TSharedPtr<FInternetAddr>> Addresses;
+	if (SocketSubsystem == nullptr || !SocketSubsystem->GetLocalAdapterAddresses(Addresses))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to list the local network adapters."));
+		OnDiscovered(false, FString());
+		return;
+	}
+
+	// adapters that only reach this machine come last
+	FString LoopbackAddress;
+	for (const TSharedPtr<FInternetAddr>& Address : Addresses)
+	{
+		if (!Address.IsValid() || Address->GetProtocolType() != FNetworkProtocolTypes::IPv4)
+		{
+			continue;
+		}
+		const FString AddressString = Address->ToString(false);
+		if (!AddressString.StartsWith(TEXT("127.")))
+		{
+			OnDiscovered(true, AddressString);
+			return;
+		}
+		LoopbackAddress = AddressString;
+	}
+	OnDiscovered(!LoopbackAddress.IsEmpty(), LoopbackAddress);
+}
+
+void FHttpAddressDiscovery::Discover(FOnDiscovered OnDiscovered)
+{
+	TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+	Request->OnProcessRequestComplete().BindLambda([OnDiscovered, Field = AddressField](FHttpRequestPtr, FHttpResponsePtr Response, bool bWasSuccessful)
+	{
+		if (!bWasSuccessful || !Response.IsValid())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to retrieve public IP address."));
+			OnDiscovered(false, FString());
+			return;
+		}
+
+		TSharedPtr<FJsonObject> JsonObject;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Response->GetContentAsString());
+		FString Address;
+		if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject->TryGetStringField(Field, Address))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to parse JSON response."));
+			OnDiscovered(false, FString());
+			return;
+		}
+		OnDiscovered(true, Address);
+	});
+	Request->SetURL(Url);
+	Request->SetVerb("GET");
+	Request->ProcessRequest();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/*
+ * Finds the address other players connect to when this machine hosts.
+ * OnDiscovered may run before Discover returns or later on the game thread;
+ * it gets false and an empty address when nothing was found.
+ */
+class HEXACHESS_API IAddressDiscovery
+{
+public:
+
+	using FOnDiscovered = TFunction<void(bool bWasSuccessful, const FString& Address)>;
+
+	virtual ~IAddressDiscovery() = default;
+
+	virtual void Discover(FOnDiscovered OnDiscovered) = 0;
+};
+
+// always reports the same address, answers immediately
+class HEXACHESS_API FOfflineAddressDiscovery : public IAddressDiscovery
+{
+public:
+
+	explicit FOfflineAddressDiscovery(const FString& InAddress = TEXT("127.0.0.1"))
+		: Address(InAddress)
+	{
+	}
+
+	virtual void Discover(FOnDiscovered OnDiscovered) override
+	{
+		OnDiscovered(true, Address);
+	}
+
+private:
+
+	FString Address;
+};
+
+// the first IPv4 address of a local adapter from the platform socket subsystem, answers immediately
+class HEXACHESS_API FLocalAddressDiscovery : public IAddressDiscovery
+{
+public:
+
+	virtual void Discover(FOnDiscovered OnDiscovered) override;
+};
+
+/*
+ * Asks a web service for the public address of this machine: a GET of Url
+ * answering a JSON object with the address in AddressField, such as
+ * httpbin.org/ip with {"origin": "x.x.x.x"}.
+ */
+class HEXACHESS_API FHttpAddressDiscovery : public IAddressDiscovery
+{
+public:
+
+	FHttpAddressDiscovery(const FString& InUrl, const FString& InAddressField)
+		: Url(InUrl)
+		, AddressField(InAddressField)
+	{
+	}
+
+	virtual void Discover(FOnDiscovered OnDiscovered) override;
+
+private:
+
+	FString Url;
+	FString AddressField;
+};
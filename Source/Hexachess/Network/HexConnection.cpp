@@ -1,43 +1,42 @@
 ﻿#include "HexConnection.h"
 
-#include "SocketSubsystem.h"
-#include "HttpModule.h"
-#include "Http.h"
+#include "AddressDiscovery.h"
 
 void AHexConnection::GetPublicIPAddress()
 {
-	TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
-	Request->OnProcessRequestComplete().BindUObject(this, &AHexConnection::OnIPAddressResponseReceived);
-	Request->SetURL(TEXT("https://httpbin.org/ip")); // Replace with the appropriate API endpoint
-	Request->SetVerb("GET");
-	Request->ProcessRequest();
-}
-
-void AHexConnection::OnIPAddressResponseReceived(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
-{
-	if (bWasSuccessful && Response.IsValid())
+	TSharedRef<IAddressDiscovery> Discovery = AddressDiscovery.IsValid() ? AddressDiscovery.ToSharedRef() : CreateAddressDiscovery();
+	TWeakObjectPtr<AHexConnection> WeakThis(this);
+	Discovery->Discover([WeakThis](bool bWasSuccessful, const FString& Address)
 	{
-		FString ResponseStr = Response->GetContentAsString();
-		// Parse the JSON response to extract the public IP address.
-		// The JSON structure may vary depending on the API used.
-		// In the case of httpbin.org, it returns something like: {"origin": "x.x.x.x"}
-        
-		TSharedPtr<FJsonObject> JsonObject;
-		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseStr);
-		if (FJsonSerializer::Deserialize(Reader, JsonObject))
+		AHexConnection* Connection = WeakThis.Get();
+		if (Connection == nullptr)
 		{
-			FString PublicIPAddress = JsonObject->GetStringField("origin");
-			MyIP = PublicIPAddress;
-			UE_LOG(LogTemp, Warning, TEXT("Public IP Address: %s"), *PublicIPAddress);
+			return;
 		}
-		else
+		if (bWasSuccessful)
 		{
-			UE_LOG(LogTemp, Error, TEXT("Failed to parse JSON response."));
+			Connection->MyIP = Address;
+			UE_LOG(LogTemp, Log, TEXT("Host IP Address: %s"), *Address);
 		}
-	}
-	else
+		Connection->OnAddressDiscovered.Broadcast(bWasSuccessful, Address);
+	});
+}
+
+void AHexConnection::SetAddressDiscovery(TSharedPtr<IAddressDiscovery> InAddressDiscovery)
+{
+	AddressDiscovery = InAddressDiscovery;
+}
+
+TSharedRef<IAddressDiscovery> AHexConnection::CreateAddressDiscovery() const
+{
+	switch (DiscoveryMode)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to retrieve public IP address."));
+	case EAddressDiscoveryMode::Offline:
+		return MakeShared<FOfflineAddressDiscovery>(OfflineAddress);
+	case EAddressDiscoveryMode::HttpEndpoint:
+		return MakeShared<FHttpAddressDiscovery>(DiscoveryUrl, DiscoveryAddressField);
+	default:
+		return MakeShared<FLocalAddressDiscovery>();
 	}
 }
 
@@ -1,10 +1,13 @@
 ﻿#pragma once
 
 #include "CoreMinimal.h"
-#include "Interfaces/IHttpRequest.h"
+
+#include "Types/AddressDiscoveryMode.h"
 
 #include "HexConnection.generated.h"
 
+class IAddressDiscovery;
+
 
 UCLASS()
 class AHexConnection : public AActor
@@ -29,15 +32,47 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "IP Conversion")
 	static FString HexToIp(const FString& HexValue, const FString& Key);
 
+	// address discovery, see Network/AddressDiscovery.h
+
+	// the public address by default, which internet room codes need; LAN play and tests opt into LocalInterface or Offline
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Address Discovery")
+	EAddressDiscoveryMode DiscoveryMode = EAddressDiscoveryMode::HttpEndpoint;
+
+	// web service for HttpEndpoint, answering a JSON object with the address in DiscoveryAddressField
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Address Discovery")
+	FString DiscoveryUrl = TEXT("https://httpbin.org/ip");
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Address Discovery")
+	FString DiscoveryAddressField = TEXT("origin");
+
+	// the address Offline reports
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Address Discovery")
+	FString OfflineAddress = TEXT("127.0.0.1");
+
+	/*
+	 * Finds the address to host on with the discovery of DiscoveryMode, or the one set
+	 * with SetAddressDiscovery, and stores it for GetMyIP. Local and offline discovery
+	 * finish before returning.
+	 */
 	UFUNCTION(BlueprintCallable)
 	void GetPublicIPAddress();
 
+	// replaces the discovery picked by DiscoveryMode, nullptr goes back to it
+	void SetAddressDiscovery(TSharedPtr<IAddressDiscovery> InAddressDiscovery);
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAddressDiscovered, bool, bWasSuccessful, const FString&, Address);
+
+	UPROPERTY(BlueprintAssignable)
+	FOnAddressDiscovered OnAddressDiscovered;
+
 	UFUNCTION(BlueprintCallable)
 	FString GetMyIP() { return MyIP; }
 	
 private:
-	
-	void OnIPAddressResponseReceived(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
+
+	TSharedRef<IAddressDiscovery> CreateAddressDiscovery() const;
+
+	TSharedPtr<IAddressDiscovery> AddressDiscovery;
 	
 	FString MyIP;
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "HexMoveSender.h"
+
+#include "Actors/ChessGod.h"
+#include "Core/HexaGameState.h"
+#include "GameFramework/PlayerController.h"
+
+
+UHexMoveSenderComponent::UHexMoveSenderComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+bool UHexMoveSenderComponent::SubmitMove(FIntPoint From, FIntPoint To, EPieceType Promotion)
+{
+	AHexaGameState* GameState = GetWorld() != nullptr ? GetWorld()->GetGameState<AHexaGameState>() : nullptr;
+	if (GameState == nullptr || GameState->ChessGod == nullptr)
+	{
+		return false;
+	}
+	const uint16 PackedMove = GameState->ChessGod->PackMove(From, To, Promotion);
+	if (PackedMove == 0)
+	{
+		return false;
+	}
+	ServerSubmitMove(PackedMove, static_cast<uint16>(GameState->GetMoveCount() + 1));
+	return true;
+}
+
+void UHexMoveSenderComponent::RequestResync()
+{
+	ServerRequestResync();
+}
+
+void UHexMoveSenderComponent::ServerSubmitMove_Implementation(uint16 PackedMove, uint16 Sequence)
+{
+	// the move is played for the side of the player this controller belongs to, never the other one
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	AHexaGameState* GameState = GetWorld()->GetGameState<AHexaGameState>();
+	if (GameState != nullptr && PlayerController != nullptr && PlayerController->PlayerState != nullptr)
+	{
+		GameState->SubmitPackedMove(PlayerController->PlayerState, PackedMove, Sequence);
+	}
+}
+
+void UHexMoveSenderComponent::ServerRequestResync_Implementation()
+{
+	if (AHexaGameState* GameState = GetWorld()->GetGameState<AHexaGameState>())
+	{
+		ClientResync(GameState->GetResyncNotation(), GameState->GetMoveCount(), GameState->GetMatchNumber());
+	}
+}
+
+void UHexMoveSenderComponent::ClientResync_Implementation(const FString& Notation, int32 MoveCount, int32 MatchNumber)
+{
+	if (AHexaGameState* GameState = GetWorld()->GetGameState<AHexaGameState>())
+	{
+		GameState->ApplyResync(Notation, MoveCount, MatchNumber);
+	}
+}
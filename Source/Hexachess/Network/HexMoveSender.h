@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+
+#include "Types/PieceType.h"
+
+#include "HexMoveSender.generated.h"
+
+
+/*
+ * The client's line to AHexaGameState on the server: sends the moves of
+ * the local player and fetches the server's position after a desync. Goes
+ * on the player controller, since the game state can't receive client RPCs.
+ */
+UCLASS(ClassGroup = (Network), meta = (BlueprintSpawnableComponent))
+class HEXACHESS_API UHexMoveSenderComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UHexMoveSenderComponent();
+
+	// packs the move against the local board and sends it, false when it isn't even a move here
+	UFUNCTION(BlueprintCallable)
+	bool SubmitMove(FIntPoint From, FIntPoint To, EPieceType Promotion = EPieceType::Queen);
+
+	// asks the server for its position, answered through AHexaGameState::ApplyResync
+	void RequestResync();
+
+protected:
+
+	UFUNCTION(Server, Reliable)
+	void ServerSubmitMove(uint16 PackedMove, uint16 Sequence);
+
+	UFUNCTION(Server, Reliable)
+	void ServerRequestResync();
+
+	UFUNCTION(Client, Reliable)
+	void ClientResync(const FString& Notation, int32 MoveCount, int32 MatchNumber);
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include "AISearchStats.generated.h"
+
+
+/*
+ * Counters of a single AI search, broadcast with the move it produced.
+ */
+USTRUCT(BlueprintType)
+struct FAISearchStats
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    int64 Nodes = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    int64 Cutoffs = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    int64 TTHits = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    int64 TablebaseHits = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    int32 DepthReached = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    float Seconds = 0.f;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "AddressDiscoveryMode.generated.h"
+
+UENUM(BlueprintType)
+enum class EAddressDiscoveryMode : uint8
+{
+    // a fixed address without touching the network, for LAN play and tests
+    Offline,
+    // the first address of a local network adapter
+    LocalInterface,
+    // asks a web service for the public address
+    HttpEndpoint
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include "PieceInfo.h"
+
+#include "BoardSetupConflict.generated.h"
+
+
+UENUM(BlueprintType)
+enum class EBoardSetupConflictType : uint8
+{
+    InvalidCell,
+    OccupiedCell,
+    KingCount,
+    InvalidNotation
+};
+
+/*
+ * A reason the board could not be set up. Piece is the offending entry
+ * of the setup, left default for conflicts about the whole board.
+ */
+USTRUCT(BlueprintType)
+struct FBoardSetupConflict
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    EBoardSetupConflictType Type = EBoardSetupConflictType::InvalidCell;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FPieceInfo Piece;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FString Message;
+};
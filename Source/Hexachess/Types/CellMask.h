@@ -0,0 +1,66 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include "CellMask.generated.h"
+
+
+/*
+ * One bit per board cell by cell index (Chess/HexCoordinates.h), laid out
+ * like the engine's CellMask. Opaque to Blueprints, which only pass it on.
+ */
+USTRUCT(BlueprintType)
+struct FCellMask
+{
+    GENERATED_BODY()
+
+    void Set(int32 Index)
+    {
+        Bits[Index >> 6] |= uint64(1) << (Index & 63);
+    }
+
+    void Clear(int32 Index)
+    {
+        Bits[Index >> 6] &= ~(uint64(1) << (Index & 63));
+    }
+
+    bool Test(int32 Index) const
+    {
+        return (Bits[Index >> 6] >> (Index & 63)) & 1;
+    }
+
+    bool IsEmpty() const
+    {
+        return (Bits[0] | Bits[1]) == 0;
+    }
+
+    FCellMask operator^(const FCellMask& Other) const
+    {
+        FCellMask Result;
+        Result.Bits[0] = Bits[0] ^ Other.Bits[0];
+        Result.Bits[1] = Bits[1] ^ Other.Bits[1];
+        return Result;
+    }
+
+    FCellMask& operator|=(const FCellMask& Other)
+    {
+        Bits[0] |= Other.Bits[0];
+        Bits[1] |= Other.Bits[1];
+        return *this;
+    }
+
+    // calls Visit with the index of every set bit, lowest first
+    template <typename FunctorType>
+    void ForEach(FunctorType&& Visit) const
+    {
+        for (int32 Word = 0; Word < 2; Word++)
+        {
+            for (uint64 Remaining = Bits[Word]; Remaining != 0; Remaining &= Remaining - 1)
+            {
+                Visit(Word * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Remaining)));
+            }
+        }
+    }
+
+    uint64 Bits[2] = {0, 0};
+};
@@ -5,6 +5,7 @@
 #include "HexaRows.generated.h"
 
 
+// one component per tile, kept for existing Blueprints; AHexaGrid now draws the tiles as instances
 USTRUCT(BlueprintType)
 struct FTileRow
 {
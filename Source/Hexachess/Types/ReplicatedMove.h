@@ -0,0 +1,32 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include "ReplicatedMove.generated.h"
+
+
+/*
+ * One move of a networked match as it goes over the wire: the engine's
+ * two byte packed move (Board::pack_move), its 1-based place in the game
+ * and the low bits of the position hash after it, 6 bytes in all. The
+ * receiver plays the move and compares both to catch a desync right away.
+ */
+USTRUCT()
+struct FReplicatedMove
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    uint16 PackedMove = 0;
+
+    UPROPERTY()
+    uint16 Sequence = 0;
+
+    UPROPERTY()
+    uint16 PositionCheck = 0;
+
+    static uint16 ToPositionCheck(uint64 PositionHash)
+    {
+        return static_cast<uint16>(PositionHash);
+    }
+};
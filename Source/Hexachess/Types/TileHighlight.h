@@ -0,0 +1,21 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include "TileHighlight.generated.h"
+
+// states of a board tile, combined as bit flags in the tile's custom data
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ETileHighlight : uint8
+{
+    None = 0 UMETA(Hidden),
+    Selected = 1 << 0,
+    Move = 1 << 1,
+    Capture = 1 << 2,
+    Attacked = 1 << 3,
+    LastMove = 1 << 4
+};
+ENUM_CLASS_FLAGS(ETileHighlight);
+
+// one bit mask per flag above, bit i of the flags is layer i
+constexpr int32 TileHighlightLayerCount = 5;
@@ -0,0 +1,125 @@
+// Command line driver for the standalone engine build.
+//
+//   hexengine perft <depth> [position]    count legal move tree leaves
+//   hexengine search <depth> [position]   run the AI search and print its move
+//   hexengine bench [depth]               search the fixed bench positions, see Chess/Bench.h
+//
+// Positions use the notation from Chess/Notation.h and default to the initial position.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include "Chess/Bench.h"
+#include "Chess/ChessEngine.h"
+#include "Chess/Notation.h"
+#include "Chess/Search.h"
+
+
+static double elapsed_seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static bool setup_position(Board& board, PositionState& state, const string& notation) {
+    string error;
+    if (!parse_position(board, notation, state, &error)) {
+        cerr << "invalid position: " << error << endl;
+        return false;
+    }
+    return true;
+}
+
+static int run_perft(int32 depth, const string& notation) {
+    Board board;
+    PositionState state;
+    if (!setup_position(board, state, notation)) {
+        return 1;
+    }
+
+    Cell::PieceColor pc = state.is_white_to_move ? Cell::PieceColor::white : Cell::PieceColor::black;
+    for (int32 d = 1; d <= depth; d++) {
+        auto start = chrono::steady_clock::now();
+        uint64 nodes = board.perft(d, pc);
+        double seconds = elapsed_seconds(start);
+        cout << "perft " << d << ": " << nodes << " nodes, " << seconds << " s" << endl;
+    }
+    return 0;
+}
+
+static int run_search(int32 depth, const string& notation) {
+    Board board;
+    PositionState state;
+    if (!setup_position(board, state, notation)) {
+        return 1;
+    }
+
+    Search search;
+    auto start = chrono::steady_clock::now();
+    SearchResult result = search.find_best_move(board, state.is_white_to_move, depth);
+    double seconds = elapsed_seconds(start);
+
+    uint64 nodes = search.get_stats().nodes;
+    cout << "best move: " << board.to_move_name(result.get_move()) << " score " << result.score << endl;
+    cout << "nodes " << nodes << ", " << seconds << " s, nps " << static_cast<uint64>(nodes / (seconds > 0 ? seconds : 1)) << endl;
+    return 0;
+}
+
+static int print_bench(int32 depth) {
+    BenchReport report = run_bench(depth);
+
+    cout << "bench v" << report.version << ", depth " << report.depth << endl;
+    for (const auto& position : report.positions) {
+        cout << "  " << left << setw(16) << position.name << right
+             << setw(12) << position.nodes << " nodes " << fixed << setprecision(3) << position.seconds << " s" << endl;
+    }
+    cout << defaultfloat;
+    cout << "nodes          " << report.nodes << endl;
+    cout << "time to depth  " << fixed << setprecision(3) << report.seconds << " s" << endl;
+    cout << "nps            " << static_cast<uint64>(report.get_nps()) << endl;
+    cout << "tt hit rate    " << setprecision(1) << report.get_tt_hit_rate() * 100.0 << " %" << endl;
+    cout << "branching      " << setprecision(2) << report.get_branching_factor() << endl;
+    cout << "signature      " << hex << setw(16) << setfill('0') << report.signature << dec << setfill(' ') << endl;
+    return 0;
+}
+
+static int print_usage() {
+    cerr << "usage: hexengine perft <depth> [position]" << endl;
+    cerr << "       hexengine search <depth> [position]" << endl;
+    cerr << "       hexengine bench [depth]" << endl;
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 2 && strcmp(argv[1], "bench") == 0) {
+        return print_bench(bench_default_depth);
+    }
+    if (argc < 3) {
+        return print_usage();
+    }
+
+    int32 depth = atoi(argv[2]);
+    if (depth <= 0) {
+        return print_usage();
+    }
+
+    string notation = initial_position_notation;
+    if (argc > 3) {
+        notation = argv[3];
+        for (int i = 4; i < argc; i++) {
+            notation += string(" ") + argv[i];
+        }
+    }
+
+    if (strcmp(argv[1], "perft") == 0) {
+        return run_perft(depth, notation);
+    }
+    if (strcmp(argv[1], "search") == 0) {
+        return run_search(depth, notation);
+    }
+    if (strcmp(argv[1], "bench") == 0) {
+        return print_bench(depth);
+    }
+    return print_usage();
+}
@@ -0,0 +1,193 @@
+// Opening book tool for the standalone engine build, see Chess/OpeningBook.h.
+//
+//   hexengine-book selfplay <games> <depth> <plies> [seed]         print self-play game logs
+//   hexengine-book build <game log> <book> [max plies] [min weight] build a book from game logs
+//   hexengine-book probe <book> [position]                          list the book moves of a position
+//
+// Game logs hold one game per line, moves in long algebraic form from the
+// initial position ("f5f6 c7c6 ..."). Move numbers ("1.") are skipped and a
+// trailing result (1-0, 0-1, 1/2-1/2, *) weighs the moves of the game.
+// Lines starting with '#' are comments.
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "Chess/ChessEngine.h"
+#include "Chess/Notation.h"
+#include "Chess/OpeningBook.h"
+#include "Chess/Search.h"
+
+
+static bool is_in_check(Board& board, Cell::PieceColor pc) {
+    for (int32 key : board.get_piece_keys(pc)) {
+        if (board.board_map[key]->get_piece_type() == Cell::PieceType::king) {
+            Position pos = board.to_position(key);
+            return board.can_be_captured(pos);
+        }
+    }
+    return false;
+}
+
+static int run_selfplay(int32 games, int32 depth, int32 plies, uint32 seed) {
+    // a few random moves first, the search alone would play the same game every time
+    const int32 random_plies = 2;
+    mt19937 random(seed);
+
+    for (int32 game = 0; game < games; game++) {
+        Board board;
+        PositionState state;
+        parse_position(board, initial_position_notation, state);
+        Search search;
+
+        bool is_white_to_move = state.is_white_to_move;
+        string result = "*";
+        ostringstream line;
+        for (int32 ply = 0; ply < plies; ply++) {
+            Cell::PieceColor pc = is_white_to_move ? Cell::PieceColor::white : Cell::PieceColor::black;
+            vector<Move> moves = board.get_legal_moves(pc);
+            if (moves.empty()) {
+                // checkmate loses, stalemate counts as a draw here
+                if (is_in_check(board, pc)) {
+                    result = is_white_to_move ? "0-1" : "1-0";
+                } else {
+                    result = "1/2-1/2";
+                }
+                break;
+            }
+
+            Move move;
+            if (ply < random_plies) {
+                move = moves[uniform_int_distribution<size_t>(0, moves.size() - 1)(random)];
+            } else {
+                search.age();
+                SearchResult search_result = search.find_best_move(board, is_white_to_move, depth);
+                move = search_result.get_move();
+            }
+
+            if (is_white_to_move) {
+                line << (ply / 2 + 1) << ". ";
+            }
+            line << board.to_move_name(move) << " ";
+
+            board.make_move(move);
+            is_white_to_move = !is_white_to_move;
+        }
+        cout << line.str() << result << endl;
+    }
+    return 0;
+}
+
+static int run_build(const string& log_path, const string& book_path, int32 max_plies, uint32 min_weight) {
+    ifstream log(log_path);
+    if (!log) {
+        cerr << "can't open " << log_path << endl;
+        return 1;
+    }
+
+    OpeningBookBuilder builder;
+    string line;
+    int32 line_number = 0;
+    int32 games = 0;
+    while (getline(log, line)) {
+        line_number++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        istringstream tokens(line);
+        vector<string> move_names;
+        OpeningBookBuilder::GameResult result = OpeningBookBuilder::unknown;
+        string token;
+        while (tokens >> token) {
+            if (token == "1-0") {
+                result = OpeningBookBuilder::white_wins;
+            } else if (token == "0-1") {
+                result = OpeningBookBuilder::black_wins;
+            } else if (token == "1/2-1/2") {
+                result = OpeningBookBuilder::draw;
+            } else if (token != "*" && token.back() != '.') {
+                move_names.push_back(token);
+            }
+        }
+
+        string error;
+        if (!builder.add_game(move_names, result, max_plies, &error)) {
+            cerr << log_path << ":" << line_number << ": " << error << endl;
+        }
+        games++;
+    }
+
+    string error;
+    if (!builder.save(book_path, min_weight, &error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    cout << games << " games, " << builder.get_move_count() << " position moves" << endl;
+    return 0;
+}
+
+static int run_probe(const string& book_path, const string& notation) {
+    OpeningBook book;
+    string error;
+    if (!book.open(book_path, &error)) {
+        cerr << error << endl;
+        return 1;
+    }
+
+    Board board;
+    PositionState state;
+    if (!parse_position(board, notation, state, &error)) {
+        cerr << "invalid position: " << error << endl;
+        return 1;
+    }
+
+    vector<BookMove> moves = book.get_moves(board, state.is_white_to_move);
+    cout << book.get_entry_count() << " entries, " << moves.size() << " moves in this position" << endl;
+    for (const BookMove& book_move : moves) {
+        cout << "  " << board.to_move_name(book_move.move) << " " << book_move.weight << endl;
+    }
+    return 0;
+}
+
+static int print_usage() {
+    cerr << "usage: hexengine-book selfplay <games> <depth> <plies> [seed]" << endl;
+    cerr << "       hexengine-book build <game log> <book> [max plies] [min weight]" << endl;
+    cerr << "       hexengine-book probe <book> [position]" << endl;
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 5 && strcmp(argv[1], "selfplay") == 0) {
+        int32 games = atoi(argv[2]);
+        int32 depth = atoi(argv[3]);
+        int32 plies = atoi(argv[4]);
+        uint32 seed = argc > 5 ? static_cast<uint32>(strtoul(argv[5], nullptr, 10)) : 1;
+        if (games <= 0 || depth <= 0 || plies <= 0) {
+            return print_usage();
+        }
+        return run_selfplay(games, depth, plies, seed);
+    }
+    if (argc >= 4 && strcmp(argv[1], "build") == 0) {
+        int32 max_plies = argc > 4 ? atoi(argv[4]) : 16;
+        uint32 min_weight = argc > 5 ? static_cast<uint32>(strtoul(argv[5], nullptr, 10)) : 1;
+        if (max_plies <= 0) {
+            return print_usage();
+        }
+        return run_build(argv[2], argv[3], max_plies, min_weight);
+    }
+    if (argc >= 3 && strcmp(argv[1], "probe") == 0) {
+        string notation = initial_position_notation;
+        if (argc > 3) {
+            notation = argv[3];
+            for (int i = 4; i < argc; i++) {
+                notation += string(" ") + argv[i];
+            }
+        }
+        return run_probe(argv[2], notation);
+    }
+    return print_usage();
+}
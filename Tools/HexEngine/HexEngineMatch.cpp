@@ -0,0 +1,512 @@
+// Headless engine matches for the standalone engine build: plays one search
+// configuration against another, or against itself, over many games on
+// every core, and reports the Elo difference of the first configuration.
+//
+//   hexengine-match <games> [options]
+//     -a <config>            first engine, depth=3 by default
+//     -b <config>            second engine, the same as the first by default
+//     -j <threads>           games played at once, every core by default
+//     --book <book>          openings from an opening book (Chess/OpeningBook.h)
+//     --book-plies <n>       book moves played at most, 8 by default
+//     --random-plies <n>     random moves after the book, 2 by default
+//     --max-plies <n>        longer games are drawn, 300 by default
+//     --tb <directory>       tablebases to adjudicate small endings
+//     --sprt <elo0> <elo1> [alpha] [beta]
+//                            stop once the first engine is shown to be elo0
+//                            or elo1 stronger, alpha and beta are 0.05
+//     --out <dataset>        write every game to a dataset, see below
+//     --seed <n>
+//
+// A config is a comma separated list of depth=N, nodes=N, movetime=MS and
+// tb=0|1 (search small endings in the tablebases, needs --tb).
+//
+// Games are played in pairs from the same opening with colors swapped, so
+// an unbalanced opening doesn't favor either engine. A game ends on mate,
+// stalemate (a draw here), threefold repetition, the fifty-move rule, the
+// tablebases, max plies, or once both engines agree for adjudication_plies
+// plies that one side is adjudication_score pawns ahead.
+//
+// The dataset holds one record per game, little endian:
+//
+//   header  "HXSP", uint32 version
+//   game    uint16 ply count, uint8 result (0 black wins, 1 draw, 2 white
+//           wins), uint8 opening plies
+//   plies   uint16 packed move (Board::pack_move), int16 search score in
+//           pawns from white's point of view, 0 for opening moves
+//
+// Every game starts from the initial position, so the positions are found
+// by replaying the moves.
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include "Chess/ChessEngine.h"
+#include "Chess/GameHistory.h"
+#include "Chess/Notation.h"
+#include "Chess/OpeningBook.h"
+#include "Chess/Search.h"
+#include "Chess/Tablebase.h"
+
+
+namespace {
+
+const char dataset_magic[4] = {'H', 'X', 'S', 'P'};
+const uint32 dataset_version = 1;
+
+const int32 adjudication_score = 10;
+const int32 adjudication_plies = 8;
+
+enum GameResult : uint8 {
+    black_wins,
+    draw,
+    white_wins
+};
+
+struct EngineConfig {
+    SearchLimits limits;
+    bool use_tablebase = false;
+};
+
+struct MatchOptions {
+    int32 games = 0;
+    EngineConfig engines[2];
+    int32 thread_count = 0;
+    string book_path;
+    int32 book_plies = 8;
+    int32 random_plies = 2;
+    int32 max_plies = 300;
+    string tablebase_directory;
+    bool is_sprt = false;
+    double elo0 = 0.0;
+    double elo1 = 5.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+    string dataset_path;
+    uint32 seed = 1;
+};
+
+struct PlyRecord {
+    uint16 move;
+    int16 score;
+};
+
+struct GameRecord {
+    GameResult result = draw;
+    int32 opening_plies = 0;
+    vector<PlyRecord> plies;
+};
+
+// wins, draws and losses of the first engine
+struct MatchScore {
+    int32 wins = 0;
+    int32 draws = 0;
+    int32 losses = 0;
+
+    int32 get_games() const {
+        return wins + draws + losses;
+    }
+};
+
+bool is_in_check(Board& board, Cell::PieceColor pc) {
+    for (int32 key : board.get_piece_keys(pc)) {
+        if (board.board_map[key]->get_piece_type() == Cell::PieceType::king) {
+            Position pos = board.to_position(key);
+            return board.can_be_captured(pos);
+        }
+    }
+    return false;
+}
+
+Cell::PieceColor to_color(bool is_white) {
+    return is_white ? Cell::PieceColor::white : Cell::PieceColor::black;
+}
+
+bool parse_config(const string& text, EngineConfig& config) {
+    istringstream fields(text);
+    string field;
+    while (getline(fields, field, ',')) {
+        const size_t equals = field.find('=');
+        if (equals == string::npos) {
+            return false;
+        }
+        const string name = field.substr(0, equals);
+        const long long value = atoll(field.c_str() + equals + 1);
+        if (name == "depth") {
+            config.limits.depth = static_cast<int32>(value);
+        } else if (name == "nodes") {
+            config.limits.nodes = static_cast<uint64>(value);
+        } else if (name == "movetime") {
+            config.limits.movetime_ms = value;
+        } else if (name == "tb") {
+            config.use_tablebase = value != 0;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+double to_score(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+double to_elo(double score) {
+    score = min(max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+// Mean and variance of the score of one game. One virtual game, a quarter win, a
+// half draw and a quarter loss, keeps the variance above zero, so a clean sweep or
+// a match of draws still gets an error margin and can reach the SPRT bounds.
+void get_score_stats(const MatchScore& score, double& mean, double& variance) {
+    const double wins = score.wins + 0.25;
+    const double draws = score.draws + 0.5;
+    const double losses = score.losses + 0.25;
+    const double games = wins + draws + losses;
+    mean = (wins + 0.5 * draws) / games;
+    variance = (wins * pow(1.0 - mean, 2.0) + draws * pow(0.5 - mean, 2.0) + losses * pow(mean, 2.0)) / games;
+}
+
+// log likelihood ratio of elo1 against elo0, in the usual normal approximation of the trinomial
+double get_llr(const MatchScore& score, double elo0, double elo1) {
+    if (score.get_games() == 0) {
+        return 0.0;
+    }
+    double mean;
+    double variance;
+    get_score_stats(score, mean, variance);
+    const double score0 = to_score(elo0);
+    const double score1 = to_score(elo1);
+    return score.get_games() * (score1 - score0) * (2.0 * mean - score0 - score1) / (2.0 * variance);
+}
+
+class MatchRunner {
+    public:
+
+    explicit MatchRunner(const MatchOptions& in_options): options(in_options) {}
+
+    bool open(string* error) {
+        if (!options.book_path.empty() && !book.open(options.book_path, error)) {
+            return false;
+        }
+        if (!options.tablebase_directory.empty() && tablebase.open_directory(options.tablebase_directory) == 0) {
+            *error = "no tablebases in " + options.tablebase_directory;
+            return false;
+        }
+        if (!options.dataset_path.empty()) {
+            dataset = fopen(options.dataset_path.c_str(), "wb");
+            if (dataset == nullptr) {
+                *error = "can't write " + options.dataset_path;
+                return false;
+            }
+            fwrite(dataset_magic, 1, sizeof(dataset_magic), dataset);
+            fwrite(&dataset_version, sizeof(dataset_version), 1, dataset);
+        }
+        return true;
+    }
+
+    ~MatchRunner() {
+        if (dataset != nullptr) {
+            fclose(dataset);
+        }
+    }
+
+    void run() {
+        int32 thread_count = options.thread_count > 0 ? options.thread_count : static_cast<int32>(thread::hardware_concurrency());
+        thread_count = max(1, min(thread_count, (options.games + 1) / 2));
+
+        vector<thread> threads;
+        for (int32 i = 0; i < thread_count; i++) {
+            threads.emplace_back([this]() {
+                play_pairs();
+            });
+        }
+        for (thread& worker : threads) {
+            worker.join();
+        }
+    }
+
+    void print_summary() const {
+        const MatchScore final_score = get_score();
+        cout << "games " << final_score.get_games() << ", +" << final_score.wins << " =" << final_score.draws << " -" << final_score.losses << endl;
+        if (final_score.get_games() == 0) {
+            return;
+        }
+
+        double mean;
+        double variance;
+        get_score_stats(final_score, mean, variance);
+        // 95% confidence
+        const double margin = 1.959964 * sqrt(variance / final_score.get_games());
+        const double elo = to_elo(mean);
+        char line[128];
+        // the score as played, the elo comes from the mean with the virtual game
+        const double played = (final_score.wins + 0.5 * final_score.draws) / final_score.get_games();
+        snprintf(line, sizeof(line), "elo %.1f +- %.1f, score %.1f%%", elo, (to_elo(mean + margin) - to_elo(mean - margin)) / 2.0, played * 100.0);
+        cout << line << endl;
+
+        if (options.is_sprt) {
+            const double lower = log(options.beta / (1.0 - options.alpha));
+            const double upper = log((1.0 - options.beta) / options.alpha);
+            const double llr = get_llr(final_score, options.elo0, options.elo1);
+            const char* verdict = llr >= upper ? "H1 accepted" : llr <= lower ? "H0 accepted" : "inconclusive";
+            snprintf(line, sizeof(line), "llr %.2f (%.2f, %.2f) [%.1f, %.1f] %s", llr, lower, upper, options.elo0, options.elo1, verdict);
+            cout << line << endl;
+        }
+    }
+
+    private:
+
+    // runs game pairs until every game is played or the sprt decided
+    void play_pairs() {
+        unique_ptr<Search> searches[2] = {make_unique<Search>(), make_unique<Search>()};
+        for (int32 i = 0; i < 2; i++) {
+            searches[i]->set_tablebase(options.engines[i].use_tablebase && tablebase.is_open() ? &tablebase : nullptr);
+        }
+
+        const int32 pair_count = (options.games + 1) / 2;
+        for (int32 pair = next_pair++; pair < pair_count && !is_decided; pair = next_pair++) {
+            const vector<Move> opening = pick_opening(pair);
+            for (int32 game = 0; game < 2 && pair * 2 + game < options.games; game++) {
+                // the first engine plays white in the first game of the pair
+                const bool is_first_white = game == 0;
+                for (unique_ptr<Search>& search : searches) {
+                    search->clear();
+                }
+                Search* white = searches[is_first_white ? 0 : 1].get();
+                Search* black = searches[is_first_white ? 1 : 0].get();
+                const GameRecord record = play_game(opening, *white, *black, options.engines[is_first_white ? 0 : 1], options.engines[is_first_white ? 1 : 0]);
+                add_result(record, is_first_white);
+            }
+        }
+    }
+
+    vector<Move> pick_opening(int32 pair) {
+        mt19937 random(options.seed * 7919u + static_cast<uint32>(pair));
+        Board board;
+        PositionState state;
+        parse_position(board, initial_position_notation, state);
+
+        vector<Move> opening;
+        bool is_white_to_move = state.is_white_to_move;
+        for (int32 ply = 0; ply < options.book_plies && book.is_open(); ply++) {
+            const Move move = book.pick_move(board, is_white_to_move, random());
+            if (!move.is_valid()) {
+                break;
+            }
+            opening.push_back(move);
+            board.make_move(move);
+            is_white_to_move = !is_white_to_move;
+        }
+        for (int32 ply = 0; ply < options.random_plies; ply++) {
+            vector<Move> moves = board.get_legal_moves(to_color(is_white_to_move));
+            if (moves.empty()) {
+                break;
+            }
+            const Move move = moves[uniform_int_distribution<size_t>(0, moves.size() - 1)(random)];
+            opening.push_back(move);
+            board.make_move(move);
+            is_white_to_move = !is_white_to_move;
+        }
+        return opening;
+    }
+
+    GameRecord play_game(const vector<Move>& opening, Search& white, Search& black, const EngineConfig& white_config, const EngineConfig& black_config) {
+        Board board;
+        PositionState state;
+        parse_position(board, initial_position_notation, state);
+        GameHistory history;
+        history.reset(board.get_hash(state.is_white_to_move), state.halfmove_clock);
+
+        GameRecord record;
+        record.opening_plies = static_cast<int32>(opening.size());
+        record.plies.reserve(options.max_plies);
+        bool is_white_to_move = state.is_white_to_move;
+        int32 winning_plies = 0;
+        int32 last_winning_sign = 0;
+
+        for (int32 ply = 0;; ply++) {
+            const Cell::PieceColor pc = to_color(is_white_to_move);
+            if (board.get_legal_moves(pc).empty()) {
+                record.result = !is_in_check(board, pc) ? draw : is_white_to_move ? black_wins : white_wins;
+                break;
+            }
+            if (history.is_threefold_repetition() || history.is_fifty_move_draw() || ply >= options.max_plies) {
+                record.result = draw;
+                break;
+            }
+            TablebaseResult tablebase_result;
+            if (tablebase.is_open() && tablebase.probe(board, is_white_to_move, tablebase_result)) {
+                if (tablebase_result.outcome == TablebaseResult::draw) {
+                    record.result = draw;
+                } else {
+                    record.result = (tablebase_result.outcome == TablebaseResult::win) == is_white_to_move ? white_wins : black_wins;
+                }
+                break;
+            }
+
+            Move move;
+            int32 score = 0;
+            if (ply < record.opening_plies) {
+                move = opening[ply];
+            } else {
+                Search& search = is_white_to_move ? white : black;
+                search.age();
+                search.set_game_history(history);
+                const SearchResult result = search.think(board, is_white_to_move, is_white_to_move ? white_config.limits : black_config.limits);
+                move = result.get_move();
+                score = result.score;
+
+                // both engines have to see the same side winning
+                const int32 sign = score >= adjudication_score ? 1 : score <= -adjudication_score ? -1 : 0;
+                winning_plies = sign != 0 && sign == last_winning_sign ? winning_plies + 1 : sign != 0 ? 1 : 0;
+                last_winning_sign = sign;
+            }
+
+            const int16 stored_score = static_cast<int16>(max(-32767, min(score, 32767)));
+            record.plies.push_back(PlyRecord{Board::pack_move(move), stored_score});
+            const bool is_irreversible = board.is_irreversible_move(move);
+            board.make_move(move);
+            is_white_to_move = !is_white_to_move;
+            history.push(board.get_hash(is_white_to_move), is_irreversible);
+
+            if (winning_plies >= adjudication_plies) {
+                record.result = last_winning_sign > 0 ? white_wins : black_wins;
+                break;
+            }
+        }
+        return record;
+    }
+
+    void add_result(const GameRecord& record, bool is_first_white) {
+        lock_guard<mutex> guard(lock);
+        if (record.result == draw) {
+            score.draws++;
+        } else if ((record.result == white_wins) == is_first_white) {
+            score.wins++;
+        } else {
+            score.losses++;
+        }
+
+        if (dataset != nullptr) {
+            const uint16 ply_count = static_cast<uint16>(record.plies.size());
+            const uint8 game_header[2] = {record.result, static_cast<uint8>(min(record.opening_plies, 255))};
+            fwrite(&ply_count, sizeof(ply_count), 1, dataset);
+            fwrite(game_header, 1, sizeof(game_header), dataset);
+            fwrite(record.plies.data(), sizeof(PlyRecord), record.plies.size(), dataset);
+        }
+
+        if (options.is_sprt && score.get_games() % 2 == 0) {
+            const double llr = get_llr(score, options.elo0, options.elo1);
+            is_decided = llr >= log((1.0 - options.beta) / options.alpha) || llr <= log(options.beta / (1.0 - options.alpha));
+        }
+        if (score.get_games() % 100 == 0) {
+            cerr << score.get_games() << " games, +" << score.wins << " =" << score.draws << " -" << score.losses << endl;
+        }
+    }
+
+    MatchScore get_score() const {
+        lock_guard<mutex> guard(lock);
+        return score;
+    }
+
+    const MatchOptions options;
+    OpeningBook book;
+    Tablebase tablebase;
+    FILE* dataset = nullptr;
+
+    atomic<int32> next_pair{0};
+    atomic<bool> is_decided{false};
+
+    mutable mutex lock;
+    MatchScore score;
+};
+
+static_assert(sizeof(PlyRecord) == 4, "dataset plies are stored as is");
+
+int print_usage() {
+    cerr << "usage: hexengine-match <games> [-a config] [-b config] [-j threads] [--book book] [--book-plies n]" << endl;
+    cerr << "                       [--random-plies n] [--max-plies n] [--tb directory]" << endl;
+    cerr << "                       [--sprt elo0 elo1 [alpha beta]] [--out dataset] [--seed n]" << endl;
+    cerr << "config: depth=N,nodes=N,movetime=MS,tb=0|1" << endl;
+    return 1;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return print_usage();
+    }
+
+    MatchOptions options;
+    options.games = atoi(argv[1]);
+    options.engines[0].limits.depth = 3;
+    bool has_second_engine = false;
+    for (int i = 2; i < argc; i++) {
+        const string option = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (option == "-a" && has_value) {
+            options.engines[0] = EngineConfig();
+            if (!parse_config(argv[++i], options.engines[0])) {
+                return print_usage();
+            }
+        } else if (option == "-b" && has_value) {
+            has_second_engine = true;
+            if (!parse_config(argv[++i], options.engines[1])) {
+                return print_usage();
+            }
+        } else if (option == "-j" && has_value) {
+            options.thread_count = atoi(argv[++i]);
+        } else if (option == "--book" && has_value) {
+            options.book_path = argv[++i];
+        } else if (option == "--book-plies" && has_value) {
+            options.book_plies = atoi(argv[++i]);
+        } else if (option == "--random-plies" && has_value) {
+            options.random_plies = atoi(argv[++i]);
+        } else if (option == "--max-plies" && has_value) {
+            options.max_plies = atoi(argv[++i]);
+        } else if (option == "--tb" && has_value) {
+            options.tablebase_directory = argv[++i];
+        } else if (option == "--sprt" && i + 2 < argc) {
+            options.is_sprt = true;
+            options.elo0 = atof(argv[++i]);
+            options.elo1 = atof(argv[++i]);
+            if (i + 2 < argc && argv[i + 1][0] != '-') {
+                options.alpha = atof(argv[++i]);
+                options.beta = atof(argv[++i]);
+            }
+        } else if (option == "--out" && has_value) {
+            options.dataset_path = argv[++i];
+        } else if (option == "--seed" && has_value) {
+            options.seed = static_cast<uint32>(strtoul(argv[++i], nullptr, 10));
+        } else {
+            return print_usage();
+        }
+    }
+    if (!has_second_engine) {
+        options.engines[1] = options.engines[0];
+    }
+    if (options.games <= 0 || options.max_plies <= 0 || options.max_plies > 0xffff) {
+        return print_usage();
+    }
+
+    MatchRunner runner(options);
+    string error;
+    if (!runner.open(&error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    runner.run();
+    runner.print_summary();
+    return 0;
+}
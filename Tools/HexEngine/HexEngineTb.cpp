@@ -0,0 +1,89 @@
+// Endgame tablebase tool for the standalone engine build, see Chess/Tablebase.h.
+//
+//   hexengine-tb generate <directory> [material ...] [-j threads]   solve endings, every standard one by default
+//   hexengine-tb probe <directory> <position>                       look a position up
+//
+// Positions use the notation from Chess/Notation.h.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "Chess/ChessEngine.h"
+#include "Chess/Notation.h"
+#include "Chess/Tablebase.h"
+
+
+static int run_generate(const string& directory, vector<string> materials, int32 thread_count) {
+    if (materials.empty()) {
+        materials = Tablebase::get_standard_materials();
+    }
+
+    for (const string& material : materials) {
+        auto start = chrono::steady_clock::now();
+        string error;
+        if (!generate_tablebase(material, directory, thread_count, &error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << Tablebase::normalize_material(material) << " " << seconds << " s" << endl;
+    }
+    return 0;
+}
+
+static int run_probe(const string& directory, const string& notation) {
+    Board board;
+    PositionState state;
+    string error;
+    if (!parse_position(board, notation, state, &error)) {
+        cerr << "invalid position: " << error << endl;
+        return 1;
+    }
+
+    Tablebase tablebase;
+    tablebase.open_directory(directory);
+    TablebaseResult result;
+    if (!tablebase.probe(board, state.is_white_to_move, result)) {
+        cout << "not in the tablebases" << endl;
+        return 0;
+    }
+
+    const char* outcomes[] = {"loss", "draw", "win"};
+    cout << outcomes[result.outcome];
+    if (result.outcome != TablebaseResult::draw) {
+        cout << ", mate in " << result.plies_to_mate << " plies";
+    }
+    cout << endl;
+    return 0;
+}
+
+static int print_usage() {
+    cerr << "usage: hexengine-tb generate <directory> [material ...] [-j threads]" << endl;
+    cerr << "       hexengine-tb probe <directory> <position>" << endl;
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "generate") == 0) {
+        vector<string> materials;
+        int32 thread_count = 0;
+        for (int i = 3; i < argc; i++) {
+            if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+                thread_count = atoi(argv[++i]);
+            } else {
+                materials.push_back(argv[i]);
+            }
+        }
+        return run_generate(argv[2], materials, thread_count);
+    }
+    if (argc >= 4 && strcmp(argv[1], "probe") == 0) {
+        string notation = argv[3];
+        for (int i = 4; i < argc; i++) {
+            notation += string(" ") + argv[i];
+        }
+        return run_probe(argv[2], notation);
+    }
+    return print_usage();
+}
@@ -0,0 +1,230 @@
+// Line based engine protocol modelled on UCI, served over stdin/stdout.
+//
+//   uci                                     -> id ..., uciok
+//   isready                                 -> readyok
+//   ucinewgame                              forget everything learned so far
+//   setoption name BookFile value <path>    answer book positions from an opening book (Chess/OpeningBook.h)
+//   setoption name TablebasePath value <dir>  score small endings from tablebases (Chess/Tablebase.h)
+//   position startpos [moves f5f6 ...]
+//   position fen <notation> [moves f5f6 ...]  notation from Chess/Notation.h
+//   go [depth N] [movetime MS] [nodes N] [infinite]
+//                                           -> info depth .. score cp .. nodes .. nps .. time .. pv ..
+//                                           -> bestmove f5f6
+//   stop                                    finish the running search now
+//   quit
+//
+// Moves use Glinski cell names (files a-l without j, ranks from 1).
+// Scores are centipawns from the point of view of the side to move.
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include "Chess/ChessEngine.h"
+#include "Chess/Notation.h"
+#include "Chess/OpeningBook.h"
+#include "Chess/Search.h"
+#include "Chess/Tablebase.h"
+
+
+class ProtocolServer {
+    public:
+
+    ProtocolServer() {
+        PositionState state;
+        parse_position(board, initial_position_notation, state);
+        history.reset(board.get_hash(state.is_white_to_move), state.halfmove_clock);
+        search->set_tablebase(&tablebase);
+    }
+
+    ~ProtocolServer() {
+        stop_search();
+    }
+
+    void run() {
+        string line;
+        while (getline(cin, line)) {
+            istringstream tokens(line);
+            string command;
+            tokens >> command;
+
+            if (command == "uci") {
+                send("id name HexEngine");
+                send("id author Hexachess");
+                send("option name BookFile type string default <empty>");
+                send("option name TablebasePath type string default <empty>");
+                send("uciok");
+            } else if (command == "isready") {
+                send("readyok");
+            } else if (command == "ucinewgame") {
+                stop_search();
+                search->clear();
+            } else if (command == "setoption") {
+                stop_search();
+                handle_setoption(tokens);
+            } else if (command == "position") {
+                stop_search();
+                handle_position(tokens);
+            } else if (command == "go") {
+                stop_search();
+                handle_go(tokens);
+            } else if (command == "stop") {
+                stop_search();
+            } else if (command == "quit") {
+                break;
+            } else if (!command.empty()) {
+                send("info string unknown command " + command);
+            }
+        }
+    }
+
+    private:
+
+    void handle_setoption(istringstream& tokens) {
+        string token;
+        string name;
+        tokens >> token >> name >> token;
+        string path;
+        getline(tokens >> ws, path);
+        if (path == "<empty>") {
+            path.clear();
+        }
+
+        if (name == "BookFile") {
+            string error;
+            if (path.empty()) {
+                book.close();
+            } else if (!book.open(path, &error)) {
+                send("info string " + error);
+            }
+        } else if (name == "TablebasePath") {
+            tablebase.close();
+            if (!path.empty()) {
+                send("info string " + to_string(tablebase.open_directory(path)) + " tablebases");
+            }
+        } else {
+            send("info string unknown option " + name);
+        }
+    }
+
+    void handle_position(istringstream& tokens) {
+        string token;
+        tokens >> token;
+        string notation;
+        if (token == "startpos") {
+            notation = initial_position_notation;
+            tokens >> token;
+        } else if (token == "fen") {
+            while (tokens >> token && token != "moves") {
+                notation += notation.empty() ? token : " " + token;
+            }
+        } else {
+            send("info string unsupported position " + token);
+            return;
+        }
+
+        PositionState state;
+        string error;
+        if (!parse_position(board, notation, state, &error)) {
+            send("info string invalid position: " + error);
+            return;
+        }
+        is_white_to_move = state.is_white_to_move;
+        history.reset(board.get_hash(is_white_to_move), state.halfmove_clock);
+
+        if (token != "moves") {
+            return;
+        }
+        while (tokens >> token) {
+            Move move = board.from_move_name(token);
+            Cell::PieceColor pc = is_white_to_move ? Cell::PieceColor::white : Cell::PieceColor::black;
+            if (!board.is_legal_move(move, pc)) {
+                send("info string illegal move " + token);
+                return;
+            }
+            bool is_irreversible = board.is_irreversible_move(move);
+            board.make_move(move);
+            is_white_to_move = !is_white_to_move;
+            history.push(board.get_hash(is_white_to_move), is_irreversible);
+        }
+    }
+
+    void handle_go(istringstream& tokens) {
+        SearchLimits limits;
+        string token;
+        while (tokens >> token) {
+            if (token == "depth") {
+                tokens >> limits.depth;
+            } else if (token == "movetime") {
+                tokens >> limits.movetime_ms;
+            } else if (token == "nodes") {
+                tokens >> limits.nodes;
+            }
+        }
+
+        if (book.is_open()) {
+            Move book_move = book.pick_move(board, is_white_to_move, static_cast<uint32>(random()));
+            if (book_move.is_valid()) {
+                send("info string book move");
+                send("bestmove " + board.to_move_name(book_move));
+                return;
+            }
+        }
+
+        search->age();
+        search->set_game_history(history);
+        search->reset_stop();
+        search_thread = thread([this, limits]() {
+            const bool side = is_white_to_move;
+            SearchResult result = search->think(board, side, limits, [this, side](const SearchInfo& info) {
+                send_info(info, side);
+            });
+            send("bestmove " + board.to_move_name(result.get_move()));
+        });
+    }
+
+    void send_info(const SearchInfo& info, bool is_white_player) {
+        int32 score = (is_white_player ? info.score : -info.score) * 100;
+        uint64 nps = info.seconds > 0.0 ? static_cast<uint64>(info.nodes / info.seconds) : 0;
+        ostringstream line;
+        line << "info depth " << info.depth << " score cp " << score << " nodes " << info.nodes
+             << " nps " << nps << " time " << static_cast<int64>(info.seconds * 1000.0) << " pv";
+        for (const Move& move : info.pv) {
+            line << " " << board.to_move_name(move);
+        }
+        send(line.str());
+    }
+
+    void stop_search() {
+        if (search_thread.joinable()) {
+            search->stop();
+            search_thread.join();
+        }
+    }
+
+    void send(const string& line) {
+        lock_guard<mutex> lock(output_mutex);
+        cout << line << endl;
+    }
+
+    Board board;
+    bool is_white_to_move = true;
+    GameHistory history;
+    unique_ptr<Search> search = make_unique<Search>();
+    OpeningBook book;
+    Tablebase tablebase;
+    mt19937 random{random_device{}()};
+    thread search_thread;
+    mutex output_mutex;
+};
+
+int main() {
+    ios::sync_with_stdio(false);
+
+    ProtocolServer server;
+    server.run();
+    return 0;
+}